@@ -2,7 +2,12 @@
  *
  * Singleton asset manager for the game.
  *
- * Its data is tied to the texture atlas used.
+ * Its data is tied to the texture atlas used: regions are placed by
+ * tools/atlaspack, which writes their coordinates into AtlasManifest.h
+ * (see "make atlas"), so that everything is drawn from the same pages.
+ *
+ * Images start decoding on worker threads as soon as the instance is first
+ * requested, and are only waited for (and uploaded) by SetGraphics().
  */
 
 #ifndef ASSETS_H__
@@ -13,15 +18,28 @@
 #include "engine/TextureRegion.h"
 #include "engine/Animation.h"
 #include "engine/Font.h"
+#include "engine/RotationCache.h"
+#include "engine/ScaleCache.h"
+#include "engine/ImageLoader.h"
+
+#include "AtlasManifest.h"
+
+#include <array>
 
 class Assets {
 	private:
 		static Assets* instance;
 
 		Engine::TextureRegion *spark1, *spark2, *spark3, *spark4;
+		// all of the font's glyphs
+		Engine::TextureRegion *fontRegion;
+		Engine::ImageLoader *mp_Loader;
 
 		Assets();
 
+		// a region of the atlas, as placed by the packer
+		Engine::TextureRegion* Region(AtlasManifest::Region const& region);
+
 		Assets(Assets const& rhs);
 
 		Assets& operator=(Assets const& rhs);
@@ -29,9 +47,21 @@ class Assets {
 		~Assets();
 
 	public:
-		Engine::Texture *background;
+		// size of the background, known ahead of decoding it
+		static constexpr int backgroundWidth = AtlasManifest::background.w;
+		static constexpr int backgroundHeight = AtlasManifest::background.h;
+
+		// how long SetGraphics() took, in seconds
+		struct LoadTimes {
+			double decode;	// of the slowest page, each on a worker
+			double wait;	// for decoding to finish
+			double upload;
+		};
+
+		LoadTimes loadTimes;
+
+		std::array<Engine::Texture*, AtlasManifest::pageCount> pages;
 		Engine::TextureRegion *backgroundRegion;
-		Engine::Texture *atlas;
 		Engine::TextureRegion *jewelYellow;
 		Engine::TextureRegion *jewelRed;
 		Engine::TextureRegion *jewelPurple;
@@ -40,11 +70,22 @@ class Assets {
 		Engine::TextureRegion *star;
 		Engine::Animation *spark;
 		Engine::Font *font;
+		// pre-rotated jewels and stars, nullptr unless CacheRotations() made it
+		Engine::RotationCache *rotations;
+		// halved copies of jewels, stars and glyphs, rendered as pages get decoded
+		Engine::ScaleCache *scales;
 
 		static Assets& Instance();
 
-		// helper needed to set renderer on textures
-		void SetGraphics(Engine::Graphics const& g);
+		/* waits for images to be decoded, along with scaled down copies of
+		 * the small sprites, and uploads them to the renderer
+		 */
+		void SetGraphics(Engine::Graphics const& g) noexcept(false);
+
+		/* pre-renders spinning sprites at steps angles, only if the
+		 * renderer is the software one, since others rotate cheaply
+		 */
+		void CacheRotations(Engine::Graphics& g, int steps);
 };
 
 #endif
@@ -0,0 +1,52 @@
+/* AtlasManifest.h - generated by tools/atlaspack from atlas.txt, do not edit
+ *
+ * Where each region was packed into the atlas pages. Coordinates are in
+ * pixels from the top left corner of the page.
+ *
+ * Page 0: 760x724, 12 regions, 89.8% used
+ */
+
+#ifndef ATLASMANIFEST_H__
+#define ATLASMANIFEST_H__
+
+namespace AtlasManifest {
+
+struct Region {
+	int page;
+	int x, y, w, h;
+};
+
+struct Size {
+	int w, h;
+};
+
+constexpr int pageCount = 1;
+
+constexpr char const* pages[pageCount] = {
+	"atlas0.png"
+};
+
+constexpr Size pageSizes[pageCount] = {
+	{ 760, 724 }
+};
+
+// PAGE(symbol, file) for every page, symbol being the file name as an identifier
+#define ATLASMANIFEST_PAGES(PAGE) \
+	PAGE(atlas0_png, "atlas0.png")
+
+constexpr Region background { 0, 1, 1, 755, 600 };
+constexpr Region jewelYellow { 0, 259, 603, 40, 40 };
+constexpr Region jewelRed { 0, 301, 603, 40, 40 };
+constexpr Region jewelPurple { 0, 343, 603, 40, 40 };
+constexpr Region jewelGreen { 0, 385, 603, 40, 40 };
+constexpr Region jewelBlue { 0, 427, 603, 40, 40 };
+constexpr Region star { 0, 469, 603, 32, 30 };
+constexpr Region font { 0, 1, 603, 256, 120 };
+constexpr Region spark1 { 0, 503, 603, 20, 20 };
+constexpr Region spark2 { 0, 525, 603, 20, 20 };
+constexpr Region spark3 { 0, 547, 603, 20, 20 };
+constexpr Region spark4 { 0, 569, 603, 20, 20 };
+
+}	// AtlasManifest
+
+#endif
@@ -0,0 +1,142 @@
+/* Jewels.h - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * The jewels that get drawn to screen, all of them in one store.
+ *
+ * Jewels sit in slots allocated once, for as many cells as the board has,
+ * and an index table says which slot each cell holds: moving jewels around
+ * the board only swaps indices, and a new game puts every slot back at its
+ * own cell in board order, without allocating anything.
+ *
+ * What every animation step touches (position, velocity, spin, explosion)
+ * is kept apart from what only changes on game events (color, size and
+ * selection), so that stepping jewels walks through tightly packed memory.
+ *
+ * Jewels are addressed by cell, in row order. Stopped() is what the game
+ * waits on: a jewel is stopped unless it is moving or exploding.
+ *
+ * Only jewels that were told to move or explode are updated: they join an
+ * active set until they stop, plus one more step to settle where drawn, and
+ * Animating() counts those not stopped yet, so an idle board costs nothing.
+ */
+
+#ifndef JEWELS_H__
+#define JEWELS_H__
+
+#include "miner/Jewel.h"
+
+#include "engine/GameObject.h"
+#include "engine/TextureRegion.h"
+#include "engine/Vector2.h"
+
+#include "Stars.h"
+
+#include <cstddef>
+#include <vector>
+
+class Jewels {
+	public:
+		// stars get ejected into stars when jewels are done exploding
+		Jewels(int numcells, Stars *stars);
+
+		// puts every jewel back at its own cell, at rest, unselected and colorless
+		void Reset();
+
+		// swaps the jewels of two cells
+		void Swap(int cell1, int cell2);
+
+		void SetColor(int cell, Miner::Jewel::Color color);
+
+		void Size(int cell, int width, int height);
+
+		// jumps to a position, without interpolating
+		void SetPosition(int cell, Engine::Vector2<double> const& position);
+
+		// moves towards target, starting at vel and speeding up by accel
+		void MoveTo(int cell, Engine::Vector2<double> const& target, double vel, double accel = 0);
+
+		// spins for time seconds, then turns into stars
+		void Explode(int cell, double time, double vel, double accel);
+
+		// skips to the end of any movement or explosion, ie. when out of sight
+		void Finish(int cell);
+
+		// toggles the selection, scaling the jewel up or back down
+		void Select(int cell);
+
+		// just an alias to Select()
+		void Deselect(int cell) { Select(cell); }
+
+		// steps the active jewels only
+		void Update(double deltatime);
+
+		bool Stopped(int cell) const;
+
+		// how many jewels are still moving or exploding
+		std::size_t Animating() const { return m_Animating; }
+
+		// whether no jewel is moving or settling, so no update changes anything
+		bool Idle() const { return m_Active.empty(); }
+
+		// whether the last update changed the position
+		bool Moved(int cell) const;
+
+		// not moving, spinning nor exploding, so it can be drawn from a cache
+		bool Settled(int cell) const;
+
+		// copies what is needed to draw the jewel of a cell
+		void Get(int cell, Engine::GameObject& object) const;
+
+	private:
+		// what every step of an animation touches
+		struct Motion {
+			Engine::Vector2<double> position;
+			Engine::Vector2<double> prevPosition;
+			Engine::Vector2<double> velocity;
+			Engine::Vector2<double> accel;
+			Engine::Vector2<double> target;
+			double angle;
+			double angularVel;
+			double angularAccel;
+			double explodingTime;
+			// heading to target, see Engine::DynamicGameObject::MoveTo()
+			bool targetMode;
+			bool exploding;
+			// counted in m_Animating
+			bool animating;
+		};
+
+		// what only changes on game events
+		struct Look {
+			Engine::TextureRegion const* region;
+			Miner::Jewel::Color color;
+			int width;
+			int height;
+			bool selected;
+		};
+
+		// slot of the jewel of each cell
+		std::vector<int> m_Slots;
+		std::vector<Motion> m_Motion;
+		std::vector<Look> m_Look;
+		Stars *mp_Stars;
+
+		// slots being updated, and where each slot is in there (-1 if not)
+		std::vector<int> m_Active;
+		std::vector<int> m_ActiveAt;
+		std::size_t m_Animating;
+
+		// puts a slot in the active set, counting it as animating
+		void Wake(int slot);
+
+		// takes a slot out of the active set
+		void Sleep(int slot);
+
+		static bool Stopped(Motion const& motion);
+
+		// turns an exploding jewel into nothing, and some stars if asked to
+		void Exploded(int slot, bool stars);
+
+		static Engine::TextureRegion const* GetJewelRegion(Miner::Jewel::Color color);
+};
+
+#endif
@@ -0,0 +1,97 @@
+/* Simulation.h - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * Runs the simulation half of a World on its own thread, in fixed steps, so
+ * that a slow Present() doesn't hold back the game logic and a long cascade
+ * doesn't hold back drawing.
+ *
+ * Clicks and camera moves are handed over to the simulation thread through a
+ * lock-free queue, and after every step the thread publishes a Snapshot for
+ * the main thread to draw. When there is nothing scheduled to change, the simulation thread
+ * sleeps until some input arrives.
+ */
+
+#ifndef SIMULATION_H__
+#define SIMULATION_H__
+
+#include <SDL2/SDL_events.h>
+#include <SDL2/SDL_mutex.h>
+#include <SDL2/SDL_thread.h>
+
+#include "util/SPSCQueue.h"
+#include "util/TripleBuffer.h"
+
+#include "Snapshot.h"
+#include "World.h"
+
+#include <atomic>
+
+class Simulation {
+	struct Input {
+		enum Type { Click, Zoom, Pan };
+
+		Type type;
+		int x, y;
+		// button released for clicks, wheel steps for zooms
+		int value;
+	};
+
+	World& m_World;
+	double const m_Step;
+	double const m_Frequency;
+
+	Util::TripleBuffer<Snapshot> m_Snapshots;
+	Util::SPSCQueue<Input, 64> m_Input;
+
+	// wakes up the simulation thread on input or when quitting
+	SDL_sem *mp_Wakeup;
+	std::atomic<bool> m_Quit;
+	// whether the main thread is blocked in WaitEvent()
+	std::atomic<bool> m_Waiting;
+	SDL_Thread *mp_Thread;
+
+	Simulation(Simulation const& rhs) = delete;
+	Simulation& operator=(Simulation const& rhs) = delete;
+
+	static int Run(void *data);
+
+	// the simulation thread's loop
+	void Loop();
+
+	// fills in and publishes a snapshot of the world
+	void Publish(Uint64 statetime);
+
+	// queues input and wakes up the simulation thread
+	void Push(Input const& input);
+
+	public:
+
+	Simulation(World& world, int tickrate) noexcept(false);
+
+	~Simulation();
+
+	// the following are meant to be called from the main thread only
+
+	// queues a click for the simulation thread
+	void Click(int x, int y, bool up);
+
+	// queues a zoom around screen point x, y, out for negative steps
+	void Zoom(int x, int y, int steps);
+
+	// queues a camera move of dx, dy screen pixels
+	void Pan(int dx, int dy);
+
+	/* like SDL_WaitEvent, but also returns 0 as soon as there is a new
+	 * snapshot to draw
+	 */
+	int WaitEvent(SDL_Event& e);
+
+	// switches to the latest snapshot published, returns false if none
+	bool Acquire() { return m_Snapshots.Acquire(); }
+
+	Snapshot const& Current() const { return m_Snapshots.Front(); }
+
+	// how far between its last two steps the current snapshot is by now
+	double Blend() const;
+};
+
+#endif
@@ -0,0 +1,67 @@
+/* Snapshot.h - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * Everything needed to draw one frame of the game, as published by the
+ * simulation thread. Game objects are copied as plain GameObjects, which
+ * keep both their current and previous positions for interpolation.
+ *
+ * Only the cells in view of the camera, plus a margin, are published.
+ */
+
+#ifndef SNAPSHOT_H__
+#define SNAPSHOT_H__
+
+#include <SDL2/SDL_stdinc.h>
+
+#include "engine/GameObject.h"
+#include "engine/Camera.h"
+
+#include "Stars.h"
+
+#include <vector>
+
+struct Snapshot {
+	struct Cell {
+		Engine::GameObject jewel;
+		// not moving, spinning nor exploding
+		bool settled;
+	};
+
+	// a rectangle of cells of the board
+	struct Window {
+		int col, row, cols, rows;
+
+		bool Contains(int c, int r) const {
+			return c >= col && c < col + cols && r >= row && r < row + rows;
+		}
+
+		bool operator==(Window const& rhs) const {
+			return col == rhs.col && row == rhs.row && cols == rhs.cols && rows == rhs.rows;
+		}
+
+		bool operator!=(Window const& rhs) const { return !(*this == rhs); }
+	};
+
+	Engine::Camera camera;
+	// the cells the camera sees, plus a margin
+	Window window;
+	// one per cell of the window, in row order
+	std::vector<Cell> cells;
+	Stars stars;
+	Engine::GameObject spark;
+
+	int score;
+	int seconds;
+	bool gameOver;
+	bool ready;
+
+	// something moves on every step, so keep drawing interpolated frames
+	bool animating;
+
+	// performance counter value at which the simulation was in this state
+	Uint64 time;
+
+	Snapshot() : camera{}, window{0, 0, 0, 0}, cells{}, stars{}, spark{}, score{0}, seconds{0},
+		gameOver{false}, ready{false}, animating{false}, time{0} {}
+};
+
+#endif
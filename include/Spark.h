@@ -46,6 +46,9 @@ class Spark : public Engine::DynamicGameObject {
 	// useful to reuse this instance
 	void Reset();
 
+	// seconds until the spark next changes its look or heads to another waypoint
+	double NextChange() const;
+
 	// true when at the last "waypoint"
 	bool Done() const {
 		return m_Done;
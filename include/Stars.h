@@ -0,0 +1,66 @@
+/* Stars.h - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * The rotating, popping and fading stars that get ejected when jewels
+ * "explode", all of them in one pool.
+ *
+ * Stars are kept as a structure of arrays, one per field, reserved up front
+ * for as many stars as the pool holds, so spawning never allocates. Updates
+ * are a single pass over the arrays using SSE2, or AVX2 if the compiler
+ * targets it (ie. -mavx2), and dead stars get the last live one moved into
+ * their place. Copying a pool copies just its live stars, which is how they
+ * get published for drawing.
+ */
+
+#ifndef STARS_H__
+#define STARS_H__
+
+#include "engine/Graphics.h"	// for GRect
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+class Stars {
+	public:
+		// the most stars alive at once, further ones are not spawned
+		static constexpr std::size_t capacity = 4096;
+
+		Stars();
+
+		// ejects count stars from x, y
+		void Spawn(double x, double y, int count);
+
+		void Update(double deltatime);
+
+		std::size_t Size() const { return m_Fields[X].size(); }
+		bool Empty() const { return m_Fields[X].empty(); }
+
+		// rectangle of a star at blend (0 to 1) between its last two positions
+		Engine::GRect Rect(std::size_t star, double blend) const;
+
+		double Angle(std::size_t star) const { return m_Fields[Angles][star]; }
+		double Alpha(std::size_t star) const { return m_Fields[Alphas][star]; }
+
+	private:
+		enum Field {
+			X, Y,
+			PrevX, PrevY,
+			VelX, VelY,
+			Angles,
+			AngularVel,
+			Alphas,
+			Sides,
+			NumFields
+		};
+
+		std::array<std::vector<float>, NumFields> m_Fields;
+
+		static constexpr int maxWidth = 20;
+		static constexpr int maxIniVelX = 800;
+		static constexpr int maxIniVelY = 800;
+		static constexpr float angularVel = 360;
+		static constexpr float gravity = 9.81 * 100;
+		static constexpr float fadeTime = 1.6;
+};
+
+#endif
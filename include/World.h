@@ -2,6 +2,16 @@
  *
  * Manages the Jewel Miner game. Implements a Miner::Listener, keeps track
  * of the game objects, score and game life cycle.
+ *
+ * The simulation half (Click, Update, Publish and NextChange) and the drawing
+ * half (Render, Invalidate) may run on different threads. They only share the
+ * immutable board geometry and assets, and talk through Snapshots.
+ *
+ * Jewels live in board space, where cells are at least as big as the jewels
+ * in the atlas, and get drawn through a camera that can zoom from fitting the
+ * whole board in the visible area down to that size. Only the cells in view,
+ * plus a margin, are ever animated, published or drawn; jewels out of view
+ * skip to the end of any animation right away.
  */
 
 #ifndef WORLD_H__
@@ -11,14 +21,17 @@
 #include "engine/Texture.h"
 #include "engine/TextureRegion.h"
 #include "engine/Font.h"
-#include "engine/SpriteBatcher.h"
+#include "engine/TextRun.h"
+#include "engine/RenderQueue.h"
+#include "engine/Camera.h"
 #include "engine/Vector2.h"
 
 #include "Assets.h"
 
-#include "Jewel.h"
-#include "Star.h"
+#include "Jewels.h"
+#include "Stars.h"
 #include "Spark.h"
+#include "Snapshot.h"
 
 #include "miner/Matrix.h"
 #include "miner/Game.h"
@@ -28,23 +41,89 @@
 
 #include <memory>
 #include <algorithm>
-#include <list>
 #include <string>
+#include <vector>
 
 class World : public Miner::Listener<Miner::Jewel> {
 	Engine::Graphics *mp_G;
-	Engine::SpriteBatcher m_SB;
-	Engine::Texture *m_Background;
-	Engine::Texture *m_Atlas;
+	Engine::RenderQueue m_RQ;
+	Engine::TextureRegion const *m_Background;
 	Engine::Font *m_Font;
 	Engine::GRect m_VisibleArea;
 
+	// labels, laid out once and then only where they change
+	Engine::TextRun m_ScoreLabel;
+	Engine::TextRun m_ScoreText;
+	Engine::TextRun m_TimeText;
+	Engine::TextRun m_GameOverText;
+
+	// camera and the cells it sees, owned by the simulation half
+	Engine::Camera m_Camera;
+	Snapshot::Window m_Window;
+	// camera and cells of the last frame drawn
+	Engine::Camera m_DrawnCamera;
+	Snapshot::Window m_DrawnWindow;
+
+	// render queue layers, drawn in this order
+	enum Layer {
+		BackgroundLayer,
+		DetailLayer,
+		BoardLayer,
+		FrontLayer
+	};
+
+	/* Static layer cache: the background and settled jewels are composed
+	 * into a render target, and only rectangles that changed since the
+	 * last frame get redrawn into it. Moving jewels, stars, the spark and
+	 * text are drawn on top of it every frame.
+	 */
+	struct CachedJewel {
+		Engine::TextureRegion const* region;	// nullptr if not in the cache
+		Engine::GRect rect;
+	};
+
+	Engine::Texture *mp_Cache;
+	Engine::RenderQueue m_CacheRQ;
+	bool m_CacheValid;
+	// one per cell of the window drawn
+	std::vector<CachedJewel> m_Cached;
+	std::vector<Engine::GRect> m_DirtyRects;
+	// whether any visible jewel is moving or spinning
+	bool m_Animating;
+
+	/* Level of detail: on boards whose cells are just a few pixels wide,
+	 * settled jewels are drawn as one texel per cell of a streaming texture
+	 * stretched over the board, and only the rest of them as sprites.
+	 */
+	Engine::Texture *mp_LOD;
+	Engine::TextureRegion m_LODRegion;
+	// texture contents, transparent for cells drawn as sprites
+	std::vector<Uint32> m_LODTexels;
+	bool m_LODValid;
+	// on screen cell size below which it is used, and whether it is now
+	int m_LODBelow;
+	bool m_LODActive;
+	/* cells wholly in view, the only ones drawn as texels since clipping
+	 * can't cut through the middle of one
+	 */
+	Snapshot::Window m_LODCells;
+
+	// what the last frame showed, to skip drawing identical frames
+	bool m_FrameDrawn;
+	int m_LastScore;
+	int m_LastSeconds;
+	bool m_LastGameOver;
+	bool m_LastReady;
+
+	// how far between the last two simulation steps this frame is drawn
+	double m_Blend;
+
 	// our matrix
 	std::shared_ptr<Miner::Matrix<Miner::Jewel>> m_Matrix;
 
 	// game objects
-	std::shared_ptr<Jewel> *jewels;
-	std::list<Star> m_StarList;
+	Stars m_Stars;
+	Jewels m_Jewels;
 	Spark m_Spark;
 
 	// rotation direction of the spinning jewels
@@ -52,7 +131,7 @@ class World : public Miner::Listener<Miner::Jewel> {
 	// coordinates of the selected jewel, if any
 	int m_SelectedCol, m_SelectedRow;
 
-	// width and height of cells in the visible matrix space
+	// width and height of cells in board space
 	int m_JewelWidth;
 	int m_JewelHeight;
 	// width and height of actual jewels, shrinked just a bit for margins
@@ -66,6 +145,9 @@ class World : public Miner::Listener<Miner::Jewel> {
 	int m_NumCols;
 	int m_NumRows;
 
+	// acceleration of falling jewels, in board space
+	double m_Gravity;
+
 	// game management variables
 	int m_Score;
 	double m_Time;
@@ -79,23 +161,56 @@ class World : public Miner::Listener<Miner::Jewel> {
 		return Engine::Vector2<double>(col * m_JewelWidth + m_MatrixWidthStart, row * m_JewelHeight + m_MatrixHeightStart);
 	}
 
-	void S2M(int x, int y, int& col, int& row) {
-		col = (x - m_VisibleArea.x) / m_JewelWidth;
-		row = (y - m_VisibleArea.y) / m_JewelHeight;
+	void S2M(Engine::Camera const& camera, int x, int y, int& col, int& row) {
+		Engine::Vector2<double> const pos = camera.ToWorld(x, y);
+		col = static_cast<int>(std::floor(pos.X() / m_JewelWidth));
+		row = static_cast<int>(std::floor(pos.Y() / m_JewelHeight));
 	}
 
 	int IDX(int col, int row) {
 		return row * m_NumCols + col;
 	}
 
+	// cells at full zoom, where jewels are drawn about their size in the atlas
+	static constexpr int fullCellSide = 42;
+	// zoom factor of each mouse wheel step
+	static constexpr double zoomStep = 1.25;
+
 	// fills in out array with a representation of the matrix's state
 	void AcquireMatrix();
 
-	// draws those nice jewels
-	void DrawMatrix();
+	// cells in view of camera, plus a margin
+	Snapshot::Window InView(Engine::Camera const& camera);
+
+	// cells wholly in view of camera
+	Snapshot::Window InFullView(Engine::Camera const& camera);
+
+	// moves the window along, finishing animations of jewels left out of it
+	void CameraMoved();
+
+	// draws those nice jewels, except the ones already in the cache
+	void DrawMatrix(Snapshot const& snapshot);
+
+	// queues an object at its interpolated position, if it has a region
+	void Draw(Engine::GameObject const& obj, Engine::Camera const* camera = nullptr);
+
+	// compares jewels to the cache contents, collecting dirty rectangles
+	void CollectDirty(Snapshot const& snapshot);
+
+	// adds a rectangle to redraw into the cache
+	void AddDirty(Engine::GRect const& rect);
+
+	// redraws the dirty rectangles of the cache
+	void RedrawCache(Snapshot const& snapshot);
+
+	// uploads texels of cells that changed, returns false if none did
+	bool UpdateLOD(Snapshot const& snapshot);
+
+	// texel standing for a settled jewel, RGBA8888
+	static Uint32 LODColor(Engine::TextureRegion const* region);
 
 	// renders the game's score and remaining time
-	void DrawText();
+	void DrawText(Snapshot const& snapshot);
 
 	// helper to perform both an array and a graphical swap of jewels
 	void SwapHelper(int col1, int row1, int col2, int row2, double vel, double accel);
@@ -104,7 +219,15 @@ class World : public Miner::Listener<Miner::Jewel> {
 
 	World(Engine::Graphics *graphics, Engine::GRect const& area, double time = 60, int numcols = 16, int numrows = 16);
 
-	~World() { delete[] jewels; }
+	~World() {
+		delete mp_Cache;
+		delete mp_LOD;
+	}
+
+	/* draws settled jewels as texels when cells are smaller than below
+	 * pixels, except with a CPU blitter; returns whether it does
+	 */
+	bool UseLevelOfDetail(int below);
 
 	// resets all of the game data to start a new game
 	void ResetGame();
@@ -114,11 +237,38 @@ class World : public Miner::Listener<Miner::Jewel> {
 
 	void ClickJewel(int x, int y);
 
+	// zooms in, or out for negative steps, around screen point x, y
+	void Zoom(int x, int y, int steps);
+
+	// moves the camera by dx, dy screen pixels
+	void Pan(int dx, int dy);
+
 	// update the world!
 	void Update(double deltatime);
 
-	// draw a frame
-	void Render(double deltatime);
+	// copies what is needed to draw the current state
+	void Publish(Snapshot& snapshot);
+
+	/* draw a snapshot at blend (0 to 1) between its last two simulation
+	 * steps, returns false if skipped because nothing changed
+	 */
+	bool Render(Snapshot const& snapshot, double blend);
+
+	/* seconds until something on screen is due to change on its own,
+	 * 0 if something is animating right now and negative if nothing
+	 * will change until there is some input
+	 */
+	double NextChange();
+
+	// forces a full redraw, ie. when render targets are lost
+	void Invalidate() {
+		m_CacheValid = false;
+		m_LODValid = false;
+		m_FrameDrawn = false;
+	}
+
+	// sprite and state change counts of the last frame
+	Engine::RenderQueue::Stats const& RenderStats() const { return m_RQ.LastStats(); }
 
 	// Miner::Listener interface implementation
 	virtual void Swapped(int col1, int row1, int col2, int row2);
@@ -134,6 +284,8 @@ class World : public Miner::Listener<Miner::Jewel> {
 	// spin a jewel to explosion
 	virtual void Delete(Miner::Event<Miner::Jewel>::Target target, int colrow, int pos);
 	virtual void Destroyed(int matches);
+	// score a group of matched jewels
+	virtual void Matched(int column, int row, int size);
 };
 
 #endif
@@ -27,6 +27,9 @@ class Animation {
 		// get the keyframe matching statetime on a lineal function
 		TextureRegion const* KeyFrame(double statetime) const;
 
+		// seconds from statetime until the keyframe changes, negative if never
+		double NextKeyFrame(double statetime) const;
+
 	private:
 		double const m_FrameDuration;
 		Mode m_Mode;
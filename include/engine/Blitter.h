@@ -0,0 +1,85 @@
+/* Blitter.h - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * A CPU renderer for hosts without a GPU, used by Graphics instead of SDL's
+ * software renderer. Sprites are blended into a premultiplied ARGB frame in
+ * system memory, which is uploaded to a streaming texture once per frame.
+ *
+ * Blending uses SSE2, or AVX2 if the compiler targets it (ie. -mavx2).
+ * Scaling is either nearest or bilinear, and rotated sprites are sampled by
+ * inverse mapping. Source textures must keep their pixels in system memory,
+ * see Texture::SetRenderer(), and the premultiplied copies of them are kept
+ * by the textures themselves.
+ */
+
+#ifndef ENGINE_BLITTER_H__
+#define ENGINE_BLITTER_H__
+
+#include <SDL2/SDL.h>
+
+#include "engine/Graphics.h"	// for GRect
+#include "engine/Texture.h"
+
+#include <vector>
+#include <stdexcept>
+
+namespace Engine {
+
+class Blitter {
+	public:
+		enum class Filter {
+			Nearest,
+			Bilinear
+		};
+
+		Blitter(SDL_Renderer *renderer, int width, int height, Filter filter) noexcept(false);
+
+		~Blitter();
+
+		void Clear();
+
+		// restricts drawing to clip, or to the whole frame on nullptr
+		void SetClip(GRect const* clip);
+
+		/* draws src from texture onto dst, rotated angle degrees clockwise
+		 * around center (relative to dst, its middle on nullptr) and
+		 * modulated by the texture's alpha
+		 */
+		void Draw(Texture *texture, GRect const& src, GRect const& dst,
+				double angle = 0, GPoint const* center = nullptr) noexcept(false);
+
+		// uploads the frame and copies it to the whole render target
+		void Upload() noexcept(false);
+
+	private:
+		// premultiplied copy of a texture's pixels
+		struct Image {
+			Uint32 const* pixels;
+			int width;
+			int height;
+		};
+
+		SDL_Renderer *mp_Renderer;
+		SDL_Texture *mp_Stream;
+		int m_Width;
+		int m_Height;
+		Filter m_Filter;
+		GRect m_Clip;
+		std::vector<Uint32> m_Frame;
+		// one row of source pixels, once scaled or rotated
+		std::vector<Uint32> m_Span;
+
+		Image Pixels(Texture *texture) noexcept(false);
+
+		void DrawScaled(Image const& image, GRect const& src, GRect const& dst,
+				GRect const& box, unsigned int alpha);
+
+		void DrawRotated(Image const& image, GRect const& src, GRect const& dst,
+				GRect const& box, double angle, double cx, double cy, unsigned int alpha);
+
+		Blitter(Blitter const& rhs) = delete;
+		Blitter& operator=(Blitter const& rhs) = delete;
+};
+
+}	// Engine
+
+#endif
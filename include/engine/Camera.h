@@ -0,0 +1,73 @@
+/* Camera.h - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * A Camera looks at part of a world bigger than the screen through a viewport,
+ * at any scale between fitting the whole world in the viewport and showing it
+ * at its full size. It maps rectangles from the world to the screen, and
+ * points on the screen back to the world.
+ *
+ * Cameras are plain values, so they can be published along with everything
+ * else needed to draw a frame.
+ */
+
+#ifndef ENGINE_CAMERA_H__
+#define ENGINE_CAMERA_H__
+
+#include "engine/Vector2.h"
+#include "engine/Graphics.h"	// for GRect
+
+namespace Engine {
+
+class Camera {
+	public:
+		Camera();
+
+		// starts zoomed out, showing as much of the world as fits
+		Camera(GRect const& viewport, double worldwidth, double worldheight);
+
+		GRect const& Viewport() const { return m_Viewport; }
+
+		// top left corner of the view, in world coordinates
+		double X() const { return m_X; }
+		double Y() const { return m_Y; }
+
+		// screen pixels per world unit
+		double Scale() const { return m_Scale; }
+		double MinScale() const { return m_MinScale; }
+
+		// size of the view, in world coordinates
+		double ViewWidth() const { return m_Viewport.w / m_Scale; }
+		double ViewHeight() const { return m_Viewport.h / m_Scale; }
+
+		// scales by factor, keeping the world under screen point x, y in place
+		void Zoom(double factor, int x, int y);
+
+		// moves the view by dx, dy screen pixels
+		void Pan(int dx, int dy);
+
+		// rounds the edges rather than the size, so neighbours never leave gaps
+		GRect ToScreen(GRect const& rect) const;
+
+		Vector2<double> ToWorld(int x, int y) const;
+
+		bool operator==(Camera const& rhs) const {
+			return m_X == rhs.m_X && m_Y == rhs.m_Y && m_Scale == rhs.m_Scale;
+		}
+
+		bool operator!=(Camera const& rhs) const { return !(*this == rhs); }
+
+	private:
+		GRect m_Viewport;
+		double m_WorldWidth;
+		double m_WorldHeight;
+		double m_X;
+		double m_Y;
+		double m_Scale;
+		double m_MinScale;
+
+		// keeps the view within the world
+		void Clamp();
+};
+
+}	// Engine
+
+#endif
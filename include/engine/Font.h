@@ -13,7 +13,7 @@
 
 #include "engine/Texture.h"
 #include "engine/TextureRegion.h"
-#include "engine/SpriteBatcher.h"
+#include "engine/SpriteTarget.h"
 
 #include "util/Math.h"
 
@@ -34,6 +34,13 @@ class Font {
 		int GlyphWidth() const { return m_GlyphWidth; }
 		int GlyphHeight() const { return m_GlyphHeight; }
 
+		// glyph sizes at any scale, leaving the current one alone
+		int GlyphWidth(double scale) const { return m_OrigGlyphWidth * scale; }
+		int GlyphHeight(double scale) const { return m_OrigGlyphHeight * scale; }
+
+		// region of a character, nullptr if the font doesn't have it
+		TextureRegion const* Glyph(char c) const;
+
 		int Kerning() const { return m_Kerning; }
 
 		void Kerning(int kerning) { m_Kerning = kerning; }
@@ -56,22 +63,22 @@ class Font {
 		 */
 		Vector2<double> GlyphBox(double angle);
 
-		void DrawText(SpriteBatcher& batcher, std::string const& text,
+		void DrawText(SpriteTarget& batcher, std::string const& text,
 				double angle = 0, double glyphangle = 0, GPoint const* center = nullptr) {
 			DrawText(batcher, text, m_Cursor.X(), m_Cursor.Y(), angle, glyphangle, center);
 		}
 
-		void DrawText(SpriteBatcher& batcher, char const c, double angle = 0,
+		void DrawText(SpriteTarget& batcher, char const c, double angle = 0,
 				double glyphangle = 0, GPoint const* center = nullptr) {
 			DrawText(batcher, std::string(1, c), m_Cursor.X(), m_Cursor.Y(), angle, glyphangle, center);
 		}
 
-		void DrawText(SpriteBatcher& batcher, char const c, int x, int y,
+		void DrawText(SpriteTarget& batcher, char const c, int x, int y,
 				double angle = 0, double glyphangle = 0, GPoint const* center = nullptr) {
 			DrawText(batcher, std::string(1, c), x, y, angle, glyphangle, center);
 		}
 
-		void DrawText(SpriteBatcher& batcher, std::string const& text, int x, int y,
+		void DrawText(SpriteTarget& batcher, std::string const& text, int x, int y,
 				double angle = 0, double glyphangle = 0, GPoint const* center = nullptr);
 
 	private:
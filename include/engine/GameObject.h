@@ -2,6 +2,10 @@
  *
  * This class implements a static game object optionally tied to a graphical
  * representation. It is a base class for more specialized objects.
+ *
+ * The position before the last update is kept around so that rendering can
+ * interpolate between simulation steps. Setting the position explicitly is
+ * considered a jump and does not interpolate.
  */
 
 #ifndef ENGINE_GAMEOBJECT_H__
@@ -27,12 +31,17 @@ class GameObject {
 
 		virtual TextureRegion const* Region() const { return mp_Region; }
 
+		void Region(TextureRegion const* region) { mp_Region = region; }
+
 		Vector2<int> RoundPos() const;
 
 		Vector2<int> RoundLL() const;
 
 		GRect Rect() const;
 
+		// rectangle at blend (0 to 1) between the previous and current position
+		GRect Rect(double blend) const;
+
 		Vector2<double> const& Position() const { return m_Position; }
 		Vector2<double>& Position() { return m_Position; }
 
@@ -40,6 +49,9 @@ class GameObject {
 
 		void SetPosition(double x, double y);
 
+		// sets the position along with the one before the last update
+		void SetPosition(Vector2<double> const& pos, Vector2<double> const& prevpos);
+
 		int Width() const { return m_Width; }
 		int Height()  const { return m_Height; }
 
@@ -71,6 +83,7 @@ class GameObject {
 
 	protected:
 		Vector2<double> m_Position;
+		Vector2<double> m_PrevPosition;
 		int m_Width;
 		int m_Height;
 		double m_Angle;
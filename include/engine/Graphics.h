@@ -15,12 +15,20 @@
 
 #include <stdexcept>
 
+// SDL_RenderGeometry() is available since SDL 2.0.18
+#define ENGINE_HAVE_GEOMETRY SDL_VERSION_ATLEAST(2, 0, 18)
+
 namespace Engine {
 
+class Blitter;
+
 typedef SDL_Point GPoint;
 typedef SDL_Rect GRect;
 typedef SDL_Window GWindow;
 typedef SDL_Renderer GRenderer;
+#if ENGINE_HAVE_GEOMETRY
+typedef SDL_Vertex GVertex;
+#endif
 
 class Graphics {
 
@@ -33,6 +41,22 @@ class Graphics {
 
 	void SetLogicalSize(int width, int height);
 
+	/* draws frames on the CPU with a Blitter from now on, instead of the
+	 * renderer, with bilinear or nearest scaling; call after Window()
+	 */
+	void UseBlitter(bool bilinear) noexcept(false);
+
+	bool UsingBlitter() const { return mp_Blitter != nullptr; }
+
+	/* draws frames at the logical size into an offscreen texture, which
+	 * Present() scales to the window in a single copy, rather than having
+	 * every copy scaled; returns false if render targets are unsupported
+	 */
+	bool UseOffscreen() noexcept(false);
+
+	// restricts drawing to clip, or to the whole target on nullptr
+	void SetClipRect(GRect const* clip);
+
 	void SetViewport(GRect const* viewport);
 
 	void SetViewport(int x, int y, int w, int h);
@@ -43,14 +67,32 @@ class Graphics {
 
 	void Clear();
 
+	// whether textures can be used as render targets
+	bool RenderTargetSupported() const;
+
+	// whether the renderer is SDL's software fallback
+	bool SoftwareRenderer() const;
+
+	// redirects rendering to a target texture, or back to the frame on nullptr
+	void SetRenderTarget(Texture *texture) noexcept(false);
+
 	void Present();
 
+	// seconds spent on the last frame from Clear() until presenting, without vsync
+	double FrameTime() const { return m_FrameTime; }
+
 	void RenderCopy(Texture *texture, GRect const* srcrect,
 			GRect const* dstrect) noexcept(false);
 
 	void RenderCopyEx(Texture *texture, GRect const* srcrect, GRect const* dstrect,
 			const double angle, GPoint const* center = nullptr) noexcept(false);
 
+#if ENGINE_HAVE_GEOMETRY
+	// draws indexed triangles textured with texture in a single call
+	void RenderGeometry(Texture *texture, GVertex const* vertices, int numvertices,
+			int const* indices, int numindices) noexcept(false);
+#endif
+
 	~Graphics();
 
 	void GetWindowSize(int& w, int& h);
@@ -62,7 +104,11 @@ class Graphics {
 
 	GWindow* mp_Window;
 	GRenderer* mp_Renderer;
+	Blitter* mp_Blitter;
+	Texture* mp_Offscreen;
 	GRect m_Viewport;
+	Uint64 m_FrameStart;
+	double m_FrameTime;
 };
 
 }	// Engine
@@ -0,0 +1,61 @@
+/* ImageCache.h - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * Keeps decoded images on disk, next to their sources, so that later runs
+ * can skip decoding: a cache file is a small header followed by the raw
+ * pixels of the surface, which get memory mapped and used in place.
+ *
+ * Cache files are tied to their source by its size and a hash of its
+ * contents, and are ignored (then rewritten) when either changes. They also
+ * keep the key of whatever step made the cached pixels out of the decoded
+ * image, see Texture::Prepare, for the caller to check.
+ *
+ * Surfaces coming out of Load() don't own their pixels, so every surface
+ * that might come from here has to be released with FreeSurface().
+ */
+
+#ifndef ENGINE_IMAGECACHE_H__
+#define ENGINE_IMAGECACHE_H__
+
+#include <SDL2/SDL_stdinc.h>
+#include <SDL2/SDL_surface.h>
+
+#include <cstddef>
+#include <string>
+
+namespace Engine {
+
+class ImageCache {
+	public:
+		// hashes the source image, safe to use from any thread
+		explicit ImageCache(std::string const& source);
+
+		/* maps the cached pixels into a surface, or returns nullptr if
+		 * there is no cache file or it is stale; key, if given, is set to
+		 * the one stored along
+		 */
+		SDL_Surface* Load(Uint64 *key = nullptr);
+
+		/* a surface over the contents of a cache file held in memory, ie.
+		 * linked into the binary, or nullptr if they aren't one; there is
+		 * no source to check it against
+		 */
+		static SDL_Surface* Load(void const* data, std::size_t size, Uint64 *key = nullptr);
+
+		/* writes a freshly decoded surface, along with the key of the step
+		 * that made it, if any; fails silently, ie. read-only dirs
+		 */
+		void Store(SDL_Surface const* surface, Uint64 key = 0);
+
+		// frees a surface, unmapping its pixels if they came from a cache file
+		static void FreeSurface(SDL_Surface *surface);
+
+	private:
+		std::string m_Filename;
+		bool m_Hashed;
+		Uint64 m_SourceSize;
+		Uint64 m_SourceHash;
+};
+
+}	// Engine
+
+#endif
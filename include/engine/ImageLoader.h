@@ -0,0 +1,80 @@
+/* ImageLoader.h - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * Decodes a set of image files in parallel, one worker thread per file, into
+ * surfaces ready to be handed to Textures. Decoding starts on construction,
+ * and Take() waits for the image asked for, if it is still being decoded.
+ *
+ * Images can also come from memory, ie. linked into the binary, instead.
+ * Each one can have a Texture::Prepare step, which also runs on its worker.
+ *
+ * Only decoding happens on the workers; uploading to the renderer has to stay
+ * on the thread that owns it, see Texture::SetRenderer().
+ */
+
+#ifndef ENGINE_IMAGELOADER_H__
+#define ENGINE_IMAGELOADER_H__
+
+#include <SDL2/SDL_surface.h>
+#include <SDL2/SDL_thread.h>
+
+#include "engine/Texture.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+namespace Engine {
+
+class ImageLoader {
+	public:
+		// an image file, or a named image held in memory if data is set
+		struct Source {
+			Source(std::string const& filename) :
+				name{filename}, data{nullptr}, size{0}, prepare{nullptr, 0} {}
+			Source(std::string const& name, void const* data, std::size_t size) :
+				name{name}, data{data}, size{size}, prepare{nullptr, 0} {}
+
+			std::string name;
+			void const* data;
+			std::size_t size;
+			// run on the decoded image, before it gets cached
+			Texture::Prepare prepare;
+		};
+
+		explicit ImageLoader(std::vector<Source> const& sources) noexcept(false);
+
+		// waits for any workers left, freeing the surfaces not taken
+		~ImageLoader();
+
+		/* waits for the index-th image and returns its surface, whose
+		 * ownership passes to the caller, or throws its decoding error
+		 */
+		SDL_Surface* Take(std::vector<Source>::size_type index) noexcept(false);
+
+		// seconds the index-th image took to decode, valid after Take()
+		double DecodeTime(std::vector<Source>::size_type index) const {
+			return m_Jobs[index].seconds;
+		}
+
+	private:
+		struct Job {
+			Source source;
+			SDL_Thread *thread;
+			SDL_Surface *surface;
+			std::string error;
+			double seconds;
+		};
+
+		// not resized once the workers start, they hold pointers into it
+		std::vector<Job> m_Jobs;
+
+		static int Run(void *data);
+
+		ImageLoader(ImageLoader const& rhs) = delete;
+		ImageLoader& operator=(ImageLoader const& rhs) = delete;
+};
+
+}	// Engine
+
+#endif
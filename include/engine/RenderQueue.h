@@ -0,0 +1,92 @@
+/* RenderQueue.h - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * A RenderQueue collects the sprites of a whole frame, each one tagged with
+ * a layer, texture, clipping rectangle and alpha, and on Flush() sorts them
+ * into the fewest state changes before handing them to a SpriteBatcher.
+ *
+ * Layers are drawn in increasing order. Within a layer, sprites are grouped
+ * by texture, then clip, then alpha; sprites sharing all of these keep the
+ * order in which they were queued.
+ *
+ * With a RotationCache set, rotated sprites of cached regions are swapped for
+ * unrotated copies of the nearest pre-rotated version as they are queued.
+ * A ScaleCache, on the other hand, is handed over to the SpriteBatcher.
+ */
+
+#ifndef ENGINE_RENDERQUEUE_H__
+#define ENGINE_RENDERQUEUE_H__
+
+#include "engine/Graphics.h"
+#include "engine/Texture.h"
+#include "engine/TextureRegion.h"
+#include "engine/SpriteBatcher.h"
+#include "engine/SpriteTarget.h"
+#include "engine/RotationCache.h"
+#include "engine/ScaleCache.h"
+
+#include <vector>
+
+namespace Engine {
+
+class RenderQueue : public SpriteTarget {
+	public:
+		// state changes performed by the last Flush()
+		struct Stats {
+			unsigned int sprites;
+			unsigned int batches;
+			unsigned int textureChanges;
+			unsigned int clipChanges;
+			unsigned int alphaChanges;
+		};
+
+		RenderQueue(Graphics *g);
+
+		// pre-rotated sprites to use instead of rotating, nullptr for none
+		void SetRotationCache(RotationCache const* rotations) { mp_Rotations = rotations; }
+
+		// pre-scaled copies for the SpriteBatcher to use, nullptr for none
+		void SetScaleCache(ScaleCache const* scales) { m_SB.SetScaleCache(scales); }
+
+		// sets the layer and clipping rectangle for the sprites drawn next
+		void Layer(int layer, GRect const* clip = nullptr);
+
+		using SpriteTarget::DrawSprite;
+
+		void DrawSprite(GRect const& dest, TextureRegion const& region, double angle = 0, double alpha = 1.0, GPoint const* center = nullptr);
+
+		// sorts and draws everything queued so far, then empties the queue
+		void Flush() noexcept(false);
+
+		Stats const& LastStats() const { return m_Stats; }
+
+	private:
+		struct Item {
+			int layer;
+			Texture* texture;
+			bool clipped;
+			GRect clip;
+			unsigned char alpha;
+			GRect dest;
+			TextureRegion const* region;
+			double angle;
+			double alphaf;
+			bool centered;
+			GPoint center;
+		};
+
+		SpriteBatcher m_SB;
+		RotationCache const* mp_Rotations;
+		int m_Layer;
+		bool m_Clipped;
+		GRect m_Clip;
+		std::vector<Item> m_Items;
+		std::vector<unsigned int> m_Order;
+		Stats m_Stats;
+
+		static bool SameClip(Item const& a, Item const& b);
+		static bool Before(Item const& a, Item const& b);
+};
+
+}	// Engine
+
+#endif
@@ -0,0 +1,54 @@
+/* RotationCache.h - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * Pre-renders a set of TextureRegions at a number of evenly spaced angles into
+ * an auxiliary texture, so that rotated sprites can be drawn as plain copies of
+ * the nearest pre-rotated version. This trades some angle precision and video
+ * memory for speed on renderers where rotating is expensive, such as SDL's
+ * software renderer.
+ *
+ * Each rotated copy is stored in a square cell as wide as the source's
+ * diagonal, so it has to be drawn onto an accordingly bigger rectangle.
+ */
+
+#ifndef ENGINE_ROTATIONCACHE_H__
+#define ENGINE_ROTATIONCACHE_H__
+
+#include "engine/Graphics.h"
+#include "engine/Texture.h"
+#include "engine/TextureRegion.h"
+
+#include <vector>
+#include <stdexcept>
+
+namespace Engine {
+
+class RotationCache {
+	public:
+		// renders steps (at least 2) rotations of each region, needs render target support
+		RotationCache(Graphics& g, std::vector<TextureRegion const*> const& regions, int steps) noexcept(false);
+
+		~RotationCache();
+
+		/* replaces region, dest and angle with the nearest pre-rotated
+		 * copy to draw without rotation, returns false if not cached
+		 */
+		bool Lookup(TextureRegion const*& region, GRect& dest, double& angle) const;
+
+		int Steps() const { return m_Steps; }
+
+		Texture* Tex() const { return mp_Texture; }
+
+	private:
+		Texture *mp_Texture;
+		int m_Steps;
+		std::vector<TextureRegion const*> m_Sources;
+		// m_Steps - 1 rotations of each source, from 360/m_Steps degrees on
+		std::vector<TextureRegion> m_Rotated;
+
+		RotationCache(RotationCache const& rhs) = delete;
+		RotationCache& operator=(RotationCache const& rhs) = delete;
+};
+
+}	// Engine
+
+#endif
@@ -0,0 +1,105 @@
+/* ScaleCache.h - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * Pre-scales a set of TextureRegions into a chain of smaller copies, each
+ * half the size of the previous one, so that sprites drawn much smaller than
+ * their region can be sampled from the closest copy instead of the full
+ * sized one. This saves both filtering work and texel bandwidth.
+ *
+ * Copies are averaged on the CPU and appended below the pixels of the very
+ * texture they come from, so sprites using them still batch together with
+ * everything else. Where they go only depends on the size of the textures,
+ * so it is laid out before any image is decoded, and Extend() renders them
+ * as a Texture::Prepare step: images cached after that, or linked into the
+ * binary from such a cache, already have their copies and go up unchanged.
+ * Key() tells layouts apart, so copies cached for another one get redone.
+ *
+ * A region can be a grid of equally sized cells, ie. font glyphs, in which
+ * case each cell is scaled on its own and can be looked up by itself.
+ */
+
+#ifndef ENGINE_SCALECACHE_H__
+#define ENGINE_SCALECACHE_H__
+
+#include "engine/Graphics.h"
+#include "engine/Texture.h"
+#include "engine/TextureRegion.h"
+
+#include <SDL2/SDL_surface.h>
+
+#include <vector>
+#include <stdexcept>
+
+namespace Engine {
+
+class ScaleCache {
+	public:
+		struct Source {
+			Source(TextureRegion const* region) :
+				region{region}, cellWidth{region->Width()}, cellHeight{region->Height()} {}
+			Source(TextureRegion const* region, int cellwidth, int cellheight) :
+				region{region}, cellWidth{cellwidth}, cellHeight{cellheight} {}
+
+			TextureRegion const* region;
+			int cellWidth, cellHeight;
+		};
+
+		// a texture and the size of its image, before any copies
+		struct Page {
+			Texture const* texture;
+			int width, height;
+		};
+
+		// the regions of sources have to be on one of pages
+		ScaleCache(std::vector<Page> const& pages, std::vector<Source> const& sources) noexcept(false);
+
+		/* the image of texture with the copies below its pixels, rendered
+		 * into a new surface (freeing the one given) unless prepared says
+		 * it already has them, ie. mapped from an ImageCache made with the
+		 * same Key(); safe to call from any thread
+		 */
+		SDL_Surface* Extend(Texture const* texture, SDL_Surface *surface, bool prepared) const noexcept(false);
+
+		// a hash of where the copies of texture go, see Texture::Prepare
+		Uint64 Key(Texture const* texture) const;
+
+		/* replaces src, a rectangle of texture, with the smallest copy that
+		 * is at least width x height, returns false if there is none
+		 */
+		bool Lookup(Texture const* texture, GRect& src, int width, int height) const;
+
+	private:
+		// a source scaled down to cells of a given size
+		struct Level {
+			GRect rect;
+			int cellWidth, cellHeight;
+		};
+
+		struct Chain {
+			Texture const* texture;
+			GRect source;
+			int cellWidth, cellHeight;
+			// from the biggest copy down to the smallest
+			std::vector<Level> levels;
+		};
+
+		// a page and how tall its image is with the copies
+		struct Layout {
+			Page page;
+			int height;
+		};
+
+		std::vector<Chain> m_Chains;
+		std::vector<Layout> m_Layouts;
+
+		// smaller cells aren't worth it
+		static constexpr int minimumSide = 4;
+
+		// places the copies of the chains on page below its pixels
+		Layout Place(Page const& page, std::vector<Chain*> const& chains) noexcept(false);
+
+		Layout const* Find(Texture const* texture) const;
+};
+
+}	// Engine
+
+#endif
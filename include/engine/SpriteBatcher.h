@@ -11,6 +11,16 @@
  * Note: testing suggests SDL 2.0's basic 2D accelerated API already batches drawing
  * operations on textures. However, this class better suits our needs and can be
  * easily ported to other backends.
+ *
+ * When built against SDL 2.0.18 or later, a batch is submitted as a single
+ * SDL_RenderGeometry() call: quads are rotated on the CPU and sprite alpha goes
+ * into vertex colors. Older SDL versions draw each sprite with RenderCopyEx().
+ *
+ * With Graphics using a CPU Blitter, sprites are handed to it one by one and
+ * clipped by it rather than by adjusting source rectangles.
+ *
+ * With a ScaleCache set, sprites drawn smaller than their region are sampled
+ * from the closest pre-scaled copy, which lives in the same texture.
  */
 
 
@@ -21,35 +31,44 @@
 #include "engine/TextureRegion.h"
 #include "engine/Sprite.h"
 #include "engine/GameObject.h"
+#include "engine/SpriteTarget.h"
+#include "engine/ScaleCache.h"
 
 #include <vector>
 #include <stdexcept>
 
 namespace Engine {
 
-class SpriteBatcher {
+class SpriteBatcher : public SpriteTarget {
 	public:
-		SpriteBatcher(Graphics *g) : m_G{g}, mp_Texture{}, mp_Visible{} {}
+		SpriteBatcher(Graphics *g) : m_G{g}, mp_Texture{}, mp_Visible{}, mp_Scales{} {}
 
-		void BeginBatch(Texture *texture, GRect *visible = nullptr);
-
-		void EndBatch() noexcept(false);
+		// pre-scaled copies to sample small sprites from, nullptr for none
+		void SetScaleCache(ScaleCache const* scales) { mp_Scales = scales; }
 
-		void DrawSprite(GameObject const& obj, TextureRegion const& region, GPoint const* center = nullptr) {
-			DrawSprite(obj.Rect(), region, obj.Angle(), obj.Alpha(), center);
-		}
+		void BeginBatch(Texture *texture, GRect const* visible = nullptr);
 
-		void DrawSprite(GameObject const& obj, GPoint const* center = nullptr);
+		void EndBatch() noexcept(false);
 
-		void DrawSprite(int x, int y, int width, int height, TextureRegion const& region, double angle = 0, double alpha = 1.0, GPoint const* center = nullptr);
+		using SpriteTarget::DrawSprite;
 
 		void DrawSprite(GRect const& dest, TextureRegion const& region, double angle = 0, double alpha = 1.0, GPoint const* center = nullptr);
 
 	private:
 		Graphics* m_G;
 		Texture* mp_Texture;
-		GRect* mp_Visible;
+		GRect const* mp_Visible;
+		ScaleCache const* mp_Scales;
 		std::vector<Sprite> m_Sprites;
+#if ENGINE_HAVE_GEOMETRY
+		// reused across batches to avoid reallocations
+		std::vector<GVertex> m_Vertices;
+		std::vector<int> m_Indices;
+
+		void EndBatchGeometry() noexcept(false);
+#endif
+
+		void EndBatchCopies() noexcept(false);
 };
 
 }	// Engine
@@ -0,0 +1,50 @@
+/* SpriteTarget.h - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * Interface for anything sprites can be drawn to, such as a SpriteBatcher or
+ * a RenderQueue. Implementations only need to provide the GRect based
+ * DrawSprite(), the rest of the overloads are built on top of it.
+ *
+ * Note: implementations must bring the overloads into scope with
+ * "using SpriteTarget::DrawSprite;" since they get hidden otherwise.
+ */
+
+#ifndef ENGINE_SPRITETARGET_H__
+#define ENGINE_SPRITETARGET_H__
+
+#include "engine/TextureRegion.h"
+#include "engine/GameObject.h"
+#include "engine/Graphics.h"	// for GRect
+
+namespace Engine {
+
+class SpriteTarget {
+	public:
+		virtual ~SpriteTarget() {}
+
+		virtual void DrawSprite(GRect const& dest, TextureRegion const& region, double angle = 0, double alpha = 1.0, GPoint const* center = nullptr) = 0;
+
+		void DrawSprite(GameObject const& obj, TextureRegion const& region, GPoint const* center = nullptr) {
+			DrawSprite(obj.Rect(), region, obj.Angle(), obj.Alpha(), center);
+		}
+
+		void DrawSprite(GameObject const& obj, GPoint const* center = nullptr) {
+			TextureRegion const* region = obj.Region();
+			// objects that don't have a region assigned are ignored
+			if (region != nullptr)
+				DrawSprite(obj.Rect(), *region, obj.Angle(), obj.Alpha(), center);
+		}
+
+		void DrawSprite(int x, int y, int width, int height, TextureRegion const& region, double angle = 0, double alpha = 1.0, GPoint const* center = nullptr) {
+			GRect dest;
+			dest.x = x;
+			dest.y = y;
+			dest.w = width;
+			dest.h = height;
+
+			DrawSprite(dest, region, angle, alpha, center);
+		}
+};
+
+}	// Engine
+
+#endif
@@ -0,0 +1,71 @@
+/* TextRun.h - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * A TextRun is a line of text laid out once into the sprites of its glyphs,
+ * for labels that are drawn every frame but rarely change, if ever. Setting
+ * the text again only lays out again from the first character that changed,
+ * so a counter ticking only touches its last digits.
+ *
+ * Runs are drawn horizontally, with the font's default kerning at their scale.
+ */
+
+#ifndef ENGINE_TEXTRUN_H__
+#define ENGINE_TEXTRUN_H__
+
+#include "engine/Font.h"
+#include "engine/TextureRegion.h"
+#include "engine/SpriteTarget.h"
+#include "engine/Vector2.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Engine {
+
+class TextRun {
+	public:
+		explicit TextRun(Font const& font, double scale = 1.0);
+
+		std::string const& Text() const { return m_Text; }
+
+		void Text(std::string const& text) { Text(text.data(), text.size()); }
+
+		void Text(char const* text, std::size_t length);
+
+		// sets the text to a number, without going through a std::string
+		void Number(int number);
+
+		double Scale() const { return m_Scale; }
+
+		void Scale(double scale);
+
+		// top left corner of the first glyph
+		void Position(Vector2<int> const& position);
+
+		void Position(int x, int y) { Position(Vector2<int>{x, y}); }
+
+		// where a glyph following the text would go
+		Vector2<int> const& Cursor() const { return m_Cursor; }
+
+		void Draw(SpriteTarget& target) const;
+
+	private:
+		struct Glyph {
+			TextureRegion const* region;	// nullptr if not in the font
+			GRect dest;
+		};
+
+		Font const* mp_Font;
+		std::string m_Text;
+		double m_Scale;
+		Vector2<int> m_Position;
+		Vector2<int> m_Cursor;
+		std::vector<Glyph> m_Glyphs;
+
+		// lays out the glyphs of the text from the given one on
+		void Layout(std::size_t from);
+};
+
+}	// Engine
+
+#endif
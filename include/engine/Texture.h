@@ -4,31 +4,84 @@
  * stored in VRAM once SetRenderer() is called, so it is generally not
  * modifiable. That means, it is basically used in tandem with
  * TextureRegions.
+ *
+ * Textures can also be created blank as render targets, or as streaming
+ * textures updated from system ram, in which case they live in VRAM from the
+ * start and have no file behind them.
+ *
+ * Decoding can happen apart from the Texture, even on another thread, with
+ * Decode(), handing the result over to an empty Texture with Adopt().
+ *
+ * Decoded images are kept in an ImageCache, so that later runs map them
+ * instead of decoding them again. Whatever a Prepare step makes out of a
+ * decoded image is what gets cached, along with the key of the step, so its
+ * work is skipped by those runs too unless the step changed.
  */
 
 #ifndef ENGINE_TEXTURE_H__
 #define ENGINE_TEXTURE_H__
 
 #include <SDL2/SDL_render.h>
+#include <SDL2/SDL_stdinc.h>
 #include <SDL2/SDL_surface.h>
 #include <SDL2/SDL_image.h>
 
+#include <cstddef>
+#include <functional>
 #include <string>
+#include <vector>
 #include <stdexcept>
 
 namespace Engine {
 
 class Texture {
 	public:
+		// an empty texture, waiting to Adopt() its pixels
+		Texture();
+
 		Texture(std::string const& filename, SDL_Renderer *renderer = nullptr);
 
+		// creates a blank render target (or streaming) texture
+		Texture(int width, int height, SDL_Renderer *renderer,
+				SDL_TextureAccess access = SDL_TEXTUREACCESS_TARGET) noexcept(false);
+
 		~Texture();
 
 		// load the texture from the disk and keep a surface (system ram) around
 		void Load(std::string const& filename) noexcept(false);
 
-		// this sets the renderer, which will upload the texture to video ram
-		void SetRenderer(SDL_Renderer *renderer);
+		/* turns a decoded surface into the one to use, returning it as is if
+		 * there is nothing to do or a new one after freeing it with
+		 * ImageCache::FreeSurface(); prepared tells that the surface already
+		 * came out of a step with the same key, ie. from the cache, and if
+		 * not it might have been made by another step, or by none
+		 */
+		struct Prepare {
+			std::function<SDL_Surface*(SDL_Surface *surface, bool prepared)> step;
+			// non-zero, and different for steps making different images
+			Uint64 key;
+		};
+
+		// decodes (or maps from the cache) an image into a RGBA8888 surface, safe to call from any thread
+		static SDL_Surface* Decode(std::string const& filename,
+				Prepare const& prepare = Prepare{ nullptr, 0 }) noexcept(false);
+
+		/* decodes an image held in memory, ie. linked into the binary, or
+		 * uses it as is if it is the contents of an ImageCache file
+		 */
+		static SDL_Surface* Decode(void const* data, std::size_t size,
+				Prepare const& prepare = Prepare{ nullptr, 0 }) noexcept(false);
+
+		// takes ownership of a decoded surface, as if loaded
+		void Adopt(SDL_Surface *surface);
+
+		/* this sets the renderer, which will upload the texture to video ram,
+		 * and frees the surface unless keepsurface, ie. for a CPU Blitter
+		 */
+		void SetRenderer(SDL_Renderer *renderer, bool keepsurface = false);
+
+		// replaces the RGBA8888 pixels of rect, or all of them, ie. of streaming textures
+		void Update(SDL_Rect const* rect, void const* pixels, int pitch) noexcept(false);
 
 		void Alpha(double alpha);
 
@@ -46,10 +99,24 @@ class Texture {
 		SDL_Renderer* Renderer() { return mp_Renderer; }
 		SDL_Texture* Tex() { return mp_Texture; }
 
+		// pixels in system ram, nullptr unless kept when setting the renderer
+		SDL_Surface* Surface() { return mp_Surface; }
+
+		/* premultiplied ARGB8888 copy of the surface, filled in by a Blitter
+		 * and emptied whenever the pixels change, so it never goes stale
+		 */
+		std::vector<Uint32>& Premultiplied() { return m_Premultiplied; }
+
 	private:
+		static SDL_Surface* Convert(SDL_Surface *decoded) noexcept(false);
+
+		// runs prepare, if any, freeing the surface if it fails
+		static SDL_Surface* Prepared(SDL_Surface *surface, Prepare const& prepare, bool prepared) noexcept(false);
+
 		SDL_Renderer *mp_Renderer;
 		SDL_Texture *mp_Texture;
 		SDL_Surface *mp_Surface;
+		std::vector<Uint32> m_Premultiplied;
 		int m_Width;
 		int m_Height;
 		double m_Alpha;
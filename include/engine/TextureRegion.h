@@ -37,7 +37,7 @@ class TextureRegion {
 
 		GRect Rect() const;
 
-		Texture const* Tex() const { return mp_Texture; }
+		Texture* Tex() const { return mp_Texture; }
 
 	private:
 		Vector2<int> m_LL;
@@ -0,0 +1,128 @@
+/* EventStream.h - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * The EventStream template class is a pull alternative to Listener: the
+ * Game records every notification of a cycle as a small packed record in a
+ * reusable buffer, and callers iterate them after Go() returns, decoding
+ * only the fields they look at.
+ *
+ * Fields of each kind of record:
+ *
+ *   Swapped, SwapOK, SwapFailed  Column(), Row(), Column2(), Row2()
+ *   Ready, CycleFinished         -
+ *   Destroyed                    Count() (connected groups)
+ *   Matched                      Column(), Row(), Count() (cells)
+ *   Deletion, Insertion          GetTarget(), Num(), Start(), Count() (size)
+ *   Delete                       GetTarget(), Num() (colrow), Start() (pos)
+ *   Fall                         Column(), Row(), Count() (gaps)
+ *   New                          Column(), Row(), GetColor(), Count() (totalgaps)
+ *
+ * Fields are 16 bits wide, which bounds the columns and rows of a board, but
+ * the counts of Destroyed and Matched take up the field after them as well,
+ * as a single group can hold more cells than a board has columns or rows.
+ */
+
+#ifndef MINER_EVENTSTREAM_H__
+#define MINER_EVENTSTREAM_H__
+
+#include "miner/Event.h"
+#include "miner/Jewel.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Miner {
+
+template <typename T>
+class EventStream {
+	public:
+
+	enum class Kind : std::uint8_t {
+		Swapped,
+		SwapOK,
+		SwapFailed,
+		Ready,
+		Destroyed,
+		Matched,
+		Deletion,
+		Insertion,
+		Delete,
+		Fall,
+		New,
+		CycleFinished
+	};
+
+	class Record {
+		public:
+
+		Record(Kind kind, int a, int b, int c, int d, int extra = 0) :
+			m_Kind{kind}, m_Extra{static_cast<std::uint8_t>(extra)},
+			m_A{static_cast<std::uint16_t>(a)},
+			m_B{static_cast<std::uint16_t>(kind == Kind::Destroyed ? a >> 16 : b)},
+			m_C{static_cast<std::uint16_t>(c)},
+			m_D{static_cast<std::uint16_t>(kind == Kind::Matched ? c >> 16 : d)} {}
+
+		Kind GetKind() const { return m_Kind; }
+
+		int Column() const { return m_A; }
+		int Row() const { return m_B; }
+		int Column2() const { return m_C; }
+		int Row2() const { return m_D; }
+
+		int Num() const { return m_A; }
+		int Start() const { return m_B; }
+		int Count() const {
+			switch (m_Kind) {
+			case Kind::Destroyed:
+				return m_A | m_B << 16;
+			case Kind::Matched:
+				return m_C | m_D << 16;
+			default:
+				return m_C;
+			}
+		}
+
+		typename Event<T>::Target GetTarget() const {
+			return static_cast<typename Event<T>::Target>(m_Extra);
+		}
+		Jewel::Color GetColor() const { return static_cast<Jewel::Color>(m_Extra); }
+
+		private:
+
+		Kind m_Kind;
+		std::uint8_t m_Extra;
+		std::uint16_t m_A, m_B, m_C, m_D;
+	};
+
+	typedef typename std::vector<Record>::const_iterator const_iterator;
+
+	EventStream() : m_Records{}, m_MatchedCells{0} {}
+
+	// the buffer keeps its capacity across cycles
+	void Clear() {
+		m_Records.clear();
+		m_MatchedCells = 0;
+	}
+
+	void Push(Kind kind, int a = 0, int b = 0, int c = 0, int d = 0, int extra = 0) {
+		m_Records.emplace_back(kind, a, b, c, d, extra);
+		if (kind == Kind::Matched)
+			m_MatchedCells += c;
+	}
+
+	const_iterator begin() const { return m_Records.cbegin(); }
+	const_iterator end() const { return m_Records.cend(); }
+	bool empty() const { return m_Records.empty(); }
+	typename std::vector<Record>::size_type size() const { return m_Records.size(); }
+
+	// number of cells matched, ie. for score deltas, without iterating
+	int MatchedCells() const { return m_MatchedCells; }
+
+	private:
+
+	std::vector<Record> m_Records;
+	int m_MatchedCells;
+};
+
+}	// Miner
+
+#endif
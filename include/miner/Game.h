@@ -6,12 +6,17 @@
  * a listener about important game events. It is designed to be as fine
  * grained as needed in order to stop and inspect the state of the game.
  *
+ * Notifications can be pushed to a Listener, and can also be recorded in an
+ * EventStream that is pulled after each call to Go() (see Events()). Games
+ * only record them when given no Listener, unless told otherwise.
+ *
  * This class only communicates matches applying to ranges of jewels.
  * How this is to be interpreted regarding the score is left for the
  * listener to define.
  *
  * Note: this is a template class in order to open the possibility to
- * implement Miner::Jewel as part of another object hierarchy.
+ * implement Miner::Jewel as part of another object hierarchy. The matrix
+ * type can also be chosen, ie. Matrix<T, 8, 8> for fixed size boards.
  */
 
 #ifndef MINER_GAME_H__
@@ -28,15 +33,17 @@
 #include "miner/Jewel.h"
 
 #include "miner/Event.h"
+#include "miner/EventStream.h"
 #include "miner/Listener.h"
 #include "miner/Matrix.h"
 
 namespace Miner {
 
-template <typename T>
+template <typename T, typename M = Matrix<T>>
 class Game {
 	// T is expected to provide a Miner::Jewel interface
 	static_assert(std::is_base_of<Miner::Jewel, T>::value, "Game's template type must be derived from Miner::Jewel!");
+	static_assert(std::is_same<T, typename M::value_type>::value, "Game's matrix must hold elements of its template type!");
 
 	public:
 
@@ -48,11 +55,18 @@ class Game {
 	};
 
 	typedef typename std::deque<Event<T>> EventQueue;
+	typedef typename EventStream<T>::Kind EventKind;
+	typedef M matrix_type;
+	typedef typename M::size_type size_type;
 
-	Game(std::shared_ptr<Matrix<T>> m, Listener<T> *listener,
+	// the listener is optional, see Events()
+	Game(std::shared_ptr<M> m, Listener<T> *listener = nullptr,
 			unsigned int col_streak_min = 3, unsigned int row_streak_min = 3) :
-				m_Matrix{m}, m_Deletions{}, mp_Listener{listener},
-				m_ColsStreak{col_streak_min}, m_RowsStreak{row_streak_min} {
+				m_Matrix{m}, mp_Listener{listener}, m_Events{}, m_EventsStale{true},
+				m_Recording{listener == nullptr},
+				m_ColsStreak{col_streak_min}, m_RowsStreak{row_streak_min},
+				m_Refill(m->NumRows()), m_Doomed(m->Size()),
+				m_Parent(m->Size()), m_GroupSize(m->Size()) {
 		Populate();
 	}
 
@@ -91,7 +105,10 @@ class Game {
 		if (CanSwap(col1, row1, col2, row2)) {
 			DoSwap(col1, row1, col2, row2);
 			m_FSMState = State::Swapped;
-			mp_Listener->Swapped(col1, row1, col2, row2);
+			StartEvents();
+			Record(EventKind::Swapped, col1, row1, col2, row2);
+			if (mp_Listener)
+				mp_Listener->Swapped(col1, row1, col2, row2);
 			swapcol1 = col1;
 			swaprow1 = row1;
 			swapcol2 = col2;
@@ -109,24 +126,52 @@ class Game {
 
 	// this is the main interface to advance the state machine
 	int Go() {
+		int ret;
+
+		StartEvents();
 		switch (m_FSMState) {
 		case State::Swapped:
 		case State::Dirty:
-			return GoDirty();
+			ret = GoDirty();
+			break;
 		case State::Destroyed:
-			return GoDestroyed();
+			ret = GoDestroyed();
+			break;
 		case State::AwaitingInput:
 		default:
-			return 0;
+			ret = 0;
 		}
+		m_EventsStale = true;
+
+		return ret;
 	}
 
+	/* events recorded by the last call to Go(), plus the preceding Swap() if
+	 * any; valid until the next call to either of them
+	 */
+	EventStream<T> const& Events() const { return m_Events; }
+
+	// whether Events() gets recorded, by default only when there is no listener
+	void RecordEvents(bool record) { m_Recording = record; }
+	bool RecordingEvents() const { return m_Recording; }
+
 	private:
 
-	std::shared_ptr<Matrix<T>> m_Matrix;
-	EventQueue m_Deletions;
+	std::shared_ptr<M> m_Matrix;
 	Listener<T> *mp_Listener;
+	EventStream<T> m_Events;
+	// whether the recorded events belong to an already finished Go()
+	bool m_EventsStale;
+	bool m_Recording;
 	unsigned int m_ColsStreak, m_RowsStreak;
+	// scratch buffer for the colors of new jewels
+	std::vector<Jewel::Color> m_Refill;
+	/* per cycle deletion mask, written by both row and column scans, and
+	 * an union-find forest linking doomed cells into connected groups
+	 */
+	std::vector<unsigned char> m_Doomed;
+	std::vector<size_type> m_Parent;
+	std::vector<size_type> m_GroupSize;
 	State m_FSMState;
 	// these are used to remember what to swap in case of
 	// a swap operation that failed to produce matches
@@ -136,10 +181,26 @@ class Game {
 	Game(Game const&);
 	Game& operator=(Game const&);
 
+	// reuses the event buffer if its events have already been published
+	void StartEvents() {
+		if (m_EventsStale) {
+			m_Events.Clear();
+			m_EventsStale = false;
+		}
+	}
+
+	// records an event for Events(), unless nobody is going to read it
+	void Record(EventKind kind, int a = 0, int b = 0, int c = 0, int d = 0, int extra = 0) {
+		if (m_Recording)
+			m_Events.Push(kind, a, b, c, d, extra);
+	}
+
 	// called when a swap can be performed but matches nothing
 	void SwapFailed() {
 		DoSwap(swapcol1, swaprow1, swapcol2, swaprow2);
-		mp_Listener->SwapFailed(swapcol1, swaprow1, swapcol2, swaprow2);
+		Record(EventKind::SwapFailed, swapcol1, swaprow1, swapcol2, swaprow2);
+		if (mp_Listener)
+			mp_Listener->SwapFailed(swapcol1, swaprow1, swapcol2, swaprow2);
 	}
 
 	// an actual swap operation, independent of result
@@ -156,7 +217,9 @@ class Game {
 		if (matches > 0) {
 			DestroyMatches();
 			if (m_FSMState == State::Swapped) {
-				mp_Listener->SwapOK(swapcol1, swaprow1, swapcol2, swaprow2);
+				Record(EventKind::SwapOK, swapcol1, swaprow1, swapcol2, swaprow2);
+				if (mp_Listener)
+					mp_Listener->SwapOK(swapcol1, swaprow1, swapcol2, swaprow2);
 			}
 			m_FSMState = State::Destroyed;
 		} else {
@@ -164,7 +227,9 @@ class Game {
 				SwapFailed();
 			}
 			m_FSMState = State::AwaitingInput;
-			mp_Listener->Ready();
+			Record(EventKind::Ready);
+			if (mp_Listener)
+				mp_Listener->Ready();
 		}
 
 		return matches;
@@ -177,121 +242,235 @@ class Game {
 			return 0;
 	}
 
-	// looks at the deletion events to nullify jewels' colors
+	// union-find root lookup, halving paths on the way up
+	size_type FindGroup(size_type cell) {
+		while (m_Parent[cell] != cell) {
+			m_Parent[cell] = m_Parent[m_Parent[cell]];
+			cell = m_Parent[cell];
+		}
+		return cell;
+	}
+
+	void JoinGroups(size_type cell1, size_type cell2) {
+		size_type root1 = FindGroup(cell1), root2 = FindGroup(cell2);
+		if (root1 != root2)
+			m_Parent[std::max(root1, root2)] = std::min(root1, root2);
+	}
+
+	// flags a cell in the deletion mask, which starts its own group
+	void Doom(size_type cell) {
+		if (!m_Doomed[cell]) {
+			m_Doomed[cell] = 1;
+			m_Parent[cell] = cell;
+			m_GroupSize[cell] = 0;
+		}
+	}
+
+	/* looks at the deletion mask to nullify jewels' colors
+	 *
+	 * Cells matched both by a row and a column are only visited once, and
+	 * each connected group of them is reported once with its size.
+	 */
 	void DestroyMatches() {
-		for (auto& deletion : m_Deletions) {
-			auto targetnum = deletion.GetTargetNum();
-			auto start = deletion.GetStart();
-			auto end = start + deletion.GetSize();
-			auto lambda = [](int col, int row, T& jewel) { jewel.SetColor(Jewel::Color::None); };
-
-			if (deletion.GetTarget() == Event<T>::Target::Row) {
-				m_Matrix->EachInRow(targetnum, lambda, start, end);
-			} else {
-				m_Matrix->EachInColumn(targetnum, lambda, start, end);
+		size_type const cols = m_Matrix->NumColumns();
+		size_type const size = m_Matrix->Size();
+		T* const data = m_Matrix->begin();
+		int groups = 0;
+
+		for (size_type cell = 0; cell < size; ++cell) {
+			if (!m_Doomed[cell])
+				continue;
+
+			data[cell].SetColor(Jewel::Color::None);
+			Record(EventKind::Delete, cell % cols, cell / cols, 0, 0,
+					static_cast<int>(Event<T>::Target::Column));
+			if (mp_Listener)
+				mp_Listener->Delete(Event<T>::Target::Column, cell % cols, cell / cols);
+			++m_GroupSize[FindGroup(cell)];
+		}
+
+		// roots are the top left-most cell of their group
+		for (size_type cell = 0; cell < size; ++cell) {
+			if (!m_Doomed[cell])
+				continue;
+
+			if (m_Parent[cell] == cell) {
+				Record(EventKind::Matched, cell % cols, cell / cols, m_GroupSize[cell]);
+				if (mp_Listener)
+					mp_Listener->Matched(cell % cols, cell / cols, m_GroupSize[cell]);
+				++groups;
 			}
+			m_Doomed[cell] = 0;
 		}
 
-		mp_Listener->Destroyed(m_Deletions.size());
-		m_Deletions.clear();
+		Record(EventKind::Destroyed, groups);
+		if (mp_Listener)
+			mp_Listener->Destroyed(groups);
 	}
 
 	// returns the number of matches found
 	int ScanMatrix() {
-		int rows = ScanColRow(Event<T>::Target::Row, m_Matrix->GetRows(), false);
-		int cols = ScanColRow(Event<T>::Target::Column, m_Matrix->GetColumns(), true);
-		return rows + cols;
-	}
+		size_type const cols = m_Matrix->NumColumns();
+		size_type const rows = m_Matrix->NumRows();
 
-	// registers an event and calls the appropriate listeners
-	void AddEvent(typename Event<T>::Type type, typename Matrix<T>::ColRow const& colrow,
-					typename Event<T>::Target target, int start, int streak) {
-		auto const& cstart = colrow.cbegin() + start;
-		typename Event<T>::container_type data(cstart, cstart + streak);
+		// the matrix stores its elements in row order
+		int r = ScanColRow(Event<T>::Target::Row, rows, cols, cols, 1, m_RowsStreak);
+		int c = ScanColRow(Event<T>::Target::Column, cols, rows, 1, cols, m_ColsStreak);
+		return r + c;
+	}
 
+	// calls the appropriate listeners with an event's data
+	void AddEvent(typename Event<T>::Type type, typename Event<T>::Target target,
+					int num, int start, typename Event<T>::container_type& data) {
 		switch (type) {
 		case Event<T>::Type::Deletion:
-			mp_Listener->Deletion(target, colrow.Num(), start, data);
-			for (int i = start; i < start + streak; ++i) {
-				mp_Listener->Delete(target, colrow.Num(), i);
-			}
-			m_Deletions.emplace_back(type, target, colrow.Num(), start, data);
+			mp_Listener->Deletion(target, num, start, data);
 			break;
 		case Event<T>::Type::Insertion:
-			mp_Listener->Insertion(target, colrow.Num(), start, data);
+			mp_Listener->Insertion(target, num, start, data);
 			break;
 		}
 	}
 
-	// scan code - looks for matches and registers them, does not touch the matrix
-	int ScanColRow(typename Event<T>::Target const target,
-				std::vector<typename Matrix<T>::ColRow> const& colrows, bool cols) {
+	// registers a deletion of a streak found in a strided column/row, dooming its cells
+	void AddDeletion(typename Event<T>::Target target, size_type num, T const* line,
+					size_type stride, size_type start, size_type streak) {
+		size_type const first = (line - m_Matrix->cbegin()) + start * stride;
+
+		Doom(first);
+		for (size_type i = 1; i < streak; ++i) {
+			Doom(first + i * stride);
+			JoinGroups(first, first + i * stride);
+		}
+
+		Record(EventKind::Deletion, num, start, streak, 0, static_cast<int>(target));
+		// copies of the deleted elements are only built for a listener
+		if (mp_Listener) {
+			std::vector<T> data;
+
+			data.reserve(streak);
+			for (size_type i = start; i < start + streak; ++i)
+				data.push_back(line[i * stride]);
+
+			AddEvent(Event<T>::Type::Deletion, target, num, start, data);
+		}
+	}
+
+	/* scan code - looks for matches and registers them, does not touch the matrix
+	 *
+	 * Walks the matrix storage in place: each of the "lines" columns/rows starts
+	 * linestride elements after the previous one, and its "length" elements are
+	 * stride elements apart. With fixed dimensions all of these are constants.
+	 */
+	int ScanColRow(typename Event<T>::Target const target, size_type const lines,
+				size_type const length, size_type const linestride,
+				size_type const stride, unsigned int const min_streak) {
 		int matches = 0;
-		unsigned int const min_streak = cols ? m_ColsStreak : m_RowsStreak;
+		T const* const data = m_Matrix->cbegin();
 
-		for (auto const& colrow : colrows) {
-			unsigned int i = 0, streak = 1;
+		for (size_type num = 0; num < lines; ++num) {
+			T const* const line = data + num * linestride;
+			unsigned int streak = 1;
 			Jewel::Color last = Jewel::Color::None;
 
-			for (auto const& jewel : colrow) {
-				if (jewel.GetColor() == last) {
-					if (jewel.Colored())
+			for (size_type i = 0; i < length; ++i) {
+				Jewel::Color const color = line[i * stride].GetColor();
+
+				if (color == last) {
+					if (color != Jewel::Color::None)
 						++streak;
 				} else {
 					if (streak >= min_streak) {
 						++matches;
-						AddEvent(Event<T>::Type::Deletion, colrow, target, i - streak, streak);
+						AddDeletion(target, num, line, stride, i - streak, streak);
 					}
 
 					streak = 1;
-					last = jewel.GetColor();
+					last = color;
 				}
-
-				++i;
 			}
 
 			// check for a streak finishing at the edge of the column/row
 			if (streak >= min_streak) {
 				++matches;
-				AddEvent(Event<T>::Type::Deletion, colrow, target, i - streak, streak);
-				streak = 1;
+				AddDeletion(target, num, line, stride, length - streak, streak);
 			}
 		}
 
 		return matches;
 	}
 
+	/* compacts a column in place, returning the number of gaps left on top
+	 *
+	 * Cells below the lowest gap are left alone. From there up, every colored
+	 * jewel is moved down in a single stable pass, falling as many cells as
+	 * gaps were found below it.
+	 */
+	int CompactColumn(size_type col, T* const column, size_type const stride, size_type const rows) {
+		size_type write = rows;
+
+		// look for the lowest gap
+		while (write > 0 && column[(write - 1) * stride].Colored())
+			--write;
+		if (write == 0)
+			return 0;
+		--write;
+
+		for (size_type read = write; read-- > 0; ) {
+			T& jewel = column[read * stride];
+			if (jewel.Colored()) {
+				column[write * stride].SetColor(jewel.GetColor());
+				jewel.SetColor(Jewel::Color::None);
+				Record(EventKind::Fall, col, read, write - read);
+				if (mp_Listener)
+					mp_Listener->Fall(col, read, write - read);
+				--write;
+			}
+		}
+
+		return write + 1;
+	}
+
 	// looks for holes/gaps in the matrix, fills them in with upper and new jewels
 	void Compact() {
-		for (auto& column : m_Matrix->GetColumns()) {
+		size_type const cols = m_Matrix->NumColumns();
+		size_type const rows = m_Matrix->NumRows();
+		T* const data = m_Matrix->begin();
+
+		for (size_type col = 0; col < cols; ++col) {
+			T* const column = data + col;
 			// bubble up the gaps...
-			int gaps = 0;
-			for (int pos = column.size() - 1; pos >= 0; --pos) {
-				auto& jewel = column[pos];
-				if (jewel.None()) {
-					++gaps;
-				} else if (gaps > 0) {
-					column[pos + gaps].SetColor(jewel.GetColor());
-					column[pos].SetColor(Jewel::Color::None);
-					mp_Listener->Fall(column.Num(), pos, gaps);
-				}
-			}
+			int const gaps = CompactColumn(col, column, cols, rows);
+
+			if (gaps == 0)
+				continue;
 
-			// ...and fill them in with random jewels
+			// ...and fill them in with random jewels, top one drawn last
+			Jewel::RandomColors(m_Refill.begin(), m_Refill.begin() + gaps);
 			for (int i = gaps - 1; i >= 0; --i) {
-				Jewel& jewel = column[i];
-				jewel.SetColRow(column.Num(), i);
-				jewel.SetRandomColor();
-				mp_Listener->New(column.Num(), i, jewel.GetColor(), gaps);
+				T& jewel = column[i * cols];
+				jewel.SetColRow(col, i);
+				jewel.SetColor(m_Refill[gaps - 1 - i]);
+				Record(EventKind::New, col, i, gaps, 0, static_cast<int>(jewel.GetColor()));
+				if (mp_Listener)
+					mp_Listener->New(col, i, jewel.GetColor(), gaps);
 			}
 
-			if (gaps > 0) {
-				m_Matrix->ReplaceColumn(column);
-				AddEvent(Event<T>::Type::Insertion, column, Event<T>::Target::Column, 0, gaps);
+			Record(EventKind::Insertion, col, 0, gaps, 0,
+					static_cast<int>(Event<T>::Target::Column));
+			if (mp_Listener) {
+				std::vector<T> inserted;
+				inserted.reserve(gaps);
+				for (int i = 0; i < gaps; ++i)
+					inserted.push_back(column[i * cols]);
+
+				AddEvent(Event<T>::Type::Insertion, Event<T>::Target::Column, col, 0, inserted);
 			}
 		}
 
-		mp_Listener->CycleFinished();
+		Record(EventKind::CycleFinished);
+		if (mp_Listener)
+			mp_Listener->CycleFinished();
 	}
 };
 
@@ -35,6 +35,15 @@ class Jewel {
 				static_cast<std::underlying_type<Color>::type>(Color::Max) - 1));
 	}
 
+	// same as RandomColor(), filling in a range of colors in bulk
+	template <typename It>
+	static void RandomColors(It first, It last) {
+		Util::rand_between(
+				static_cast<std::underlying_type<Color>::type>(Color::None) + 1,
+				static_cast<std::underlying_type<Color>::type>(Color::Max) - 1,
+				first, last);
+	}
+
 	Jewel() : Jewel(Color::None) {}
 	explicit Jewel(Color color, int col = 0, int row = 0) : m_Color{color}, m_Col{col}, m_Row{row} {}
 	virtual ~Jewel() {}
@@ -19,12 +19,16 @@ class Listener {
 		virtual void SwapOK(int col1, int row1, int col2, int row2) = 0;
 		virtual void SwapFailed(int col1, int row1, int col2, int row2) = 0;
 		virtual void Ready() = 0;
+		// matches is the number of connected groups destroyed
 		virtual void Destroyed(int matches) = 0;
+		// a connected group of matched jewels, given by its top left-most cell
+		virtual void Matched(int column, int row, int size) = 0;
 		virtual void Deletion(typename Event<T>::Target target, int num, int start, typename Event<T>::container_type& container) = 0;
 		virtual void Insertion(typename Event<T>::Target target, int num, int start, typename Event<T>::container_type& container) = 0;
 		virtual void CycleFinished() = 0;
 		virtual void Fall(int column, int row, int gaps) = 0;
 		virtual void New(int column, int row, Jewel::Color color, int totalgaps) = 0;
+		// called once per matched cell, even if both a row and a column matched it
 		virtual void Delete(typename Event<T>::Target target, int colrow, int pos) = 0;
 
 	protected:
@@ -3,6 +3,9 @@
  * The Matrix template class provides extra functionality on top of MatrixBase.
  * It defines the Column and Row containers, and provides methods to get the
  * matrix element data within those objects.
+ *
+ * Boards with a known size can use fixed dimensions, ie. Matrix<T, 8, 8>,
+ * which keep their elements inline and compile their bounds as constants.
  */
 
 #ifndef MINER_MATRIX_H__
@@ -15,12 +18,12 @@
 
 namespace Miner {
 
-template <typename T>
-class Matrix : public MatrixBase<T> {
+template <typename T, unsigned int Cols = Dynamic, unsigned int Rows = Dynamic>
+class Matrix : public MatrixBase<T, Cols, Rows> {
 	public:
 
-	typedef typename MatrixBase<T>::size_type size_type;
-	typedef typename MatrixBase<T>::InvalidAddressing InvalidAddressing;
+	typedef typename MatrixBase<T, Cols, Rows>::size_type size_type;
+	typedef typename MatrixBase<T, Cols, Rows>::InvalidAddressing InvalidAddressing;
 
 	/* The column/row class:
 	 *
@@ -38,15 +41,15 @@ class Matrix : public MatrixBase<T> {
 			explicit ColRow_(size_type capacity, Matrix::size_type num = 0) :
 				Util::RAContainerFacade<U>{capacity}, m_Num{num} {}
 			ColRow_(ColRow_ const& rhs) : Util::RAContainerFacade<U>{rhs}, m_Num{rhs.m_Num} {}
-			ColRow_(ColRow_&& rhs) : Util::RAContainerFacade<U>{rhs}, m_Num{std::move(rhs.m_Num)} {}
+			ColRow_(ColRow_&& rhs) noexcept : Util::RAContainerFacade<U>{std::move(rhs)}, m_Num{rhs.m_Num} {}
 			ColRow_& operator=(ColRow_ const& rhs) {
 				Util::RAContainerFacade<U>::operator=(rhs);
 				m_Num = rhs.m_Num;
 				return *this;
 			}
-			ColRow_& operator=(ColRow_&& rhs) {
-				Util::RAContainerFacade<U>::operator=(rhs);
-				m_Num = std::move(rhs.m_Num);
+			ColRow_& operator=(ColRow_&& rhs) noexcept {
+				Util::RAContainerFacade<U>::operator=(std::move(rhs));
+				m_Num = rhs.m_Num;
 				return *this;
 			}
 
@@ -58,11 +61,12 @@ class Matrix : public MatrixBase<T> {
 	typedef ColRow Column;
 	typedef ColRow Row;
 
-	explicit Matrix(size_type squaresize) : MatrixBase<T>(squaresize) {}
-	explicit Matrix(size_type columns, size_type rows) : MatrixBase<T>(columns, rows) {}
+	Matrix() : MatrixBase<T, Cols, Rows>() {}
+	explicit Matrix(size_type squaresize) : MatrixBase<T, Cols, Rows>(squaresize) {}
+	explicit Matrix(size_type columns, size_type rows) : MatrixBase<T, Cols, Rows>(columns, rows) {}
 	virtual ~Matrix() {}
 
-	Column const GetColumn(size_type colnum, size_type start = 0, size_type end = 0) const {
+	Column GetColumn(size_type colnum, size_type start = 0, size_type end = 0) const {
 		this->CheckRange(start, end, this->NumRows());
 
 		Column col(end - start, colnum);
@@ -74,11 +78,7 @@ class Matrix : public MatrixBase<T> {
 		return col;
 	}
 
-	Column GetColumn(size_type colnum, size_type start = 0, size_type end = 0) {
-		return const_cast<Column&&>( static_cast<Matrix<T> const&>(*this).GetColumn(colnum, start, end) );
-	}
-
-	std::vector<Column> const GetColumns(size_type cstart = 0, size_type cend = 0, size_type rstart = 0, size_type rend = 0) const {
+	std::vector<Column> GetColumns(size_type cstart = 0, size_type cend = 0, size_type rstart = 0, size_type rend = 0) const {
 		this->CheckRange(cstart, cend, this->NumColumns());
 
 		std::vector<Column> columns(cend - cstart);
@@ -90,11 +90,7 @@ class Matrix : public MatrixBase<T> {
 		return columns;
 	}
 
-	std::vector<Column> GetColumns(size_type cstart = 0, size_type cend = 0, size_type rstart = 0, size_type rend = 0) {
-		return const_cast<std::vector<Column>&&>( static_cast<Matrix<T> const&>(*this).GetColumns(cstart, cend, rstart, rend) );
-	}
-
-	Row const GetRow(size_type rownum, size_type start = 0, size_type end = 0) const {
+	Row GetRow(size_type rownum, size_type start = 0, size_type end = 0) const {
 		this->CheckRange(start, end, this->NumColumns());
 
 		Row row(end - start, rownum);
@@ -106,11 +102,7 @@ class Matrix : public MatrixBase<T> {
 		return row;
 	}
 
-	Row GetRow(size_type row, size_type start = 0, size_type end = 0) {
-		return const_cast<Row&&>( static_cast<Matrix<T> const&>(*this).GetRow(row, start, end) );
-	}
-
-	std::vector<Row> const GetRows(size_type rstart = 0, size_type rend = 0, size_type cstart = 0, size_type cend = 0) const {
+	std::vector<Row> GetRows(size_type rstart = 0, size_type rend = 0, size_type cstart = 0, size_type cend = 0) const {
 		this->CheckRange(rstart, rend, this->NumRows());
 
 		std::vector<Row> rows(rend - rstart);
@@ -122,10 +114,6 @@ class Matrix : public MatrixBase<T> {
 		return rows;
 	}
 
-	std::vector<Row> GetRows(size_type rstart = 0, size_type rend = 0, size_type cstart = 0, size_type cend = 0) {
-		return const_cast<std::vector<Row>&&>( static_cast<Matrix<T> const&>(*this).GetRows(rstart, rend, cstart, cend) );
-	}
-
 	void ReplaceColumn(Column const& replace, size_type start = 0, size_type end = 0) {
 		this->CheckRange(start, end, this->NumRows());
 		size_type colnum = replace.Num();
@@ -1,6 +1,9 @@
 /* MatrixBase.h - Copyright (c) 2014 Alejandro Martinez Ruiz
  *
  * A template class describing a matrix of elements.
+ *
+ * Dimensions can be fixed at compile time by specifying Cols and Rows, or
+ * left as Dynamic (the default) to be given at construction time.
  */
 
 #ifndef MINER_MATRIXBASE_H__
@@ -11,81 +14,38 @@
 #include <algorithm>
 #include <stdexcept>
 
+#include "miner/MatrixStorage.h"
+
 namespace Miner {
 
-template <typename T>
+template <typename T, unsigned int Cols = Dynamic, unsigned int Rows = Dynamic>
 class MatrixBase {
 	public:
 		// basic iterator support types
 		typedef T value_type;
 		typedef value_type* iterator;
 		typedef value_type const* const_iterator;
-		typedef unsigned int size_type;
+		typedef typename MatrixStorage<T, Cols, Rows>::size_type size_type;
 
 		// in C++11, 2+ args should do well to use explicit too
-		explicit MatrixBase(size_type columns, size_type rows) :
-				m_Columns {columns},
-				m_Rows {rows},
-				m_Size {m_Columns * m_Rows},
-				m_Data {} {
-			Init();
+		explicit MatrixBase(size_type columns, size_type rows) : m_Storage(columns, rows) {
+			// refuse to build a useless matrix (or one not matching fixed dimensions)
+			if (columns == 0 || rows == 0 ||
+					columns != NumColumns() || rows != NumRows())
+				throw InvalidAddressing();
 		}
 
 		explicit MatrixBase(size_type squaresize) : MatrixBase(squaresize, squaresize) {}
 
-		// copy constructor
-		MatrixBase(MatrixBase const& rhs) : m_Columns{rhs.m_Columns}, m_Rows{rhs.m_Rows},
-				m_Size{rhs.m_Size}, m_Data{new T[m_Size]} {
-			try {
-				std::copy(rhs.cbegin(), rhs.cend(), &m_Data[0]);
-			} catch (std::exception &e) {
-				delete[] m_Data;
-				throw;
-			}
-		}
-
-		// move constructor
-		MatrixBase(MatrixBase&& rhs) : m_Columns{std::move(rhs.m_Columns)},
-				m_Rows{std::move(rhs.m_Rows)}, m_Size{std::move(rhs.m_Size)},
-				m_Data{std::move(rhs.m_Data)} {
-			rhs.m_Data = nullptr;
-		}
-
-		// assignment operator implemented by swapping buffers
-		MatrixBase& operator=(MatrixBase const& rhs) {
-			if (this == &rhs)
-				return *this;
-
-			T *copy = new T[rhs.m_Size];
-
-			try {
-				std::copy(rhs.cbegin(), rhs.cend(), &copy[0]);
-			} catch (std::exception &e) {
-				delete[] copy;
-				throw;
-			}
-
-			m_Columns = rhs.m_Columns;
-			m_Rows = rhs.m_Rows;
-			m_Size = m_Columns * m_Rows;
-			delete[] m_Data;
-			m_Data = copy;
-
-			return *this;
-		}
-
-		// move assignment operator
-		MatrixBase& operator=(MatrixBase&& rhs) {
-			m_Columns = std::move(rhs.m_Columns);
-			m_Rows = std::move(rhs.m_Rows);
-			m_Size = std::move(rhs.m_Size);
-			m_Data = std::move(rhs.m_Data);
-			rhs.m_Data = nullptr;
+		// only useful with fixed dimensions, Dynamic ones will throw
+		MatrixBase() : MatrixBase(Cols, Rows) {}
 
-			return *this;
-		}
+		MatrixBase(MatrixBase const& rhs) = default;
+		MatrixBase(MatrixBase&& rhs) = default;
+		MatrixBase& operator=(MatrixBase const& rhs) = default;
+		MatrixBase& operator=(MatrixBase&& rhs) = default;
 
-		virtual ~MatrixBase() noexcept { delete[] m_Data; }
+		virtual ~MatrixBase() noexcept {}
 
 		// exceptions thrown
 		struct InvalidAddressing : public std::out_of_range {
@@ -102,15 +62,15 @@ class MatrixBase {
 		};
 
 		// convenience methods encapsulating attributes
-		size_type NumColumns() const { return m_Columns; }
-		size_type NumRows() const { return m_Rows; }
-		size_type Size() const { return m_Size; }
+		size_type NumColumns() const { return m_Storage.NumColumns(); }
+		size_type NumRows() const { return m_Storage.NumRows(); }
+		size_type Size() const { return m_Storage.Size(); }
 
 		// provide basic iterators
-		iterator begin() noexcept { return &m_Data[0]; }
-		iterator end() noexcept { return &m_Data[this->Size()]; }
-		const_iterator cbegin() const noexcept { return &const_cast<value_type const *>(m_Data)[0]; }
-		const_iterator cend() const noexcept { return &const_cast<value_type const *>(m_Data)[this->Size()]; }
+		iterator begin() noexcept { return m_Storage.Data(); }
+		iterator end() noexcept { return m_Storage.Data() + this->Size(); }
+		const_iterator cbegin() const noexcept { return m_Storage.Data(); }
+		const_iterator cend() const noexcept { return m_Storage.Data() + this->Size(); }
 
 		// crange() can be used in C++11 for-ranges as a const range
 		MatrixBase const& crange() const noexcept { return *this; }
@@ -118,16 +78,16 @@ class MatrixBase {
 		// addressing single T elements
 		T const& operator()(size_type column, size_type row) const {
 			// test for correct addressing
-			if (row >= m_Rows)
+			if (row >= NumRows())
 				throw InvalidRow();
-			if (column >= m_Columns)
+			if (column >= NumColumns())
 				throw InvalidColumn();
 
-			return m_Data[m_Columns * row + column];
+			return m_Storage.Data()[NumColumns() * row + column];
 		}
 
 		T& operator()(size_type column, size_type row) {
-			return const_cast<T&>( static_cast<MatrixBase<T> const&>(*this)(column, row) );
+			return const_cast<T&>( static_cast<MatrixBase const&>(*this)(column, row) );
 		}
 
 		// these two below are synonyms to operator()
@@ -136,7 +96,7 @@ class MatrixBase {
 		}
 
 		T& At(size_type column, size_type row) {
-			return const_cast<T&>( static_cast<MatrixBase<T> const&>(*this)(column, row) );
+			return const_cast<T&>( static_cast<MatrixBase const&>(*this)(column, row) );
 		}
 
 		/* The methods below perform operations on T elements in columns and rows.
@@ -178,16 +138,7 @@ class MatrixBase {
 
 	private:
 
-		void Init() {
-			// refuse to build a useless matrix
-			if (m_Columns == 0 || m_Rows == 0)
-				throw InvalidAddressing();
-
-			m_Data = new T[m_Size];
-		}
-
-		size_type m_Columns, m_Rows, m_Size;
-		T* m_Data;
+		MatrixStorage<T, Cols, Rows> m_Storage;
 };
 
 }	// Miner
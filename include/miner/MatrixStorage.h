@@ -0,0 +1,125 @@
+/* MatrixStorage.h - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * Element storage for MatrixBase.
+ *
+ * A matrix whose dimensions are known at compile time keeps its elements
+ * inline in a std::array and reports constexpr dimensions, so that index
+ * calculations and loop bounds fold into constants. Specifying Dynamic for
+ * both dimensions selects a heap allocated buffer sized at runtime.
+ */
+
+#ifndef MINER_MATRIXSTORAGE_H__
+#define MINER_MATRIXSTORAGE_H__
+
+#include <array>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+namespace Miner {
+
+// dimension value meaning "specified at runtime"
+constexpr unsigned int Dynamic = 0;
+
+// fixed dimensions storage
+template <typename T, unsigned int Cols, unsigned int Rows>
+class MatrixStorage {
+	static_assert(Cols != Dynamic && Rows != Dynamic,
+		"Either both or none of the matrix dimensions must be Dynamic!");
+
+	public:
+		typedef unsigned int size_type;
+
+		// the arguments are ignored, MatrixBase checks they match
+		explicit MatrixStorage(size_type columns = Cols, size_type rows = Rows) : m_Data() {}
+
+		static constexpr size_type NumColumns() { return Cols; }
+		static constexpr size_type NumRows() { return Rows; }
+		static constexpr size_type Size() { return Cols * Rows; }
+
+		T* Data() noexcept { return m_Data.data(); }
+		T const* Data() const noexcept { return m_Data.data(); }
+
+	private:
+		std::array<T, Cols * Rows> m_Data;
+};
+
+// runtime dimensions storage
+template <typename T>
+class MatrixStorage<T, Dynamic, Dynamic> {
+	public:
+		typedef unsigned int size_type;
+
+		MatrixStorage(size_type columns, size_type rows) :
+				m_Columns {columns},
+				m_Rows {rows},
+				m_Size {m_Columns * m_Rows},
+				m_Data {new T[m_Size]} {}
+
+		// copy constructor
+		MatrixStorage(MatrixStorage const& rhs) : m_Columns{rhs.m_Columns}, m_Rows{rhs.m_Rows},
+				m_Size{rhs.m_Size}, m_Data{new T[m_Size]} {
+			try {
+				std::copy(&rhs.m_Data[0], &rhs.m_Data[m_Size], &m_Data[0]);
+			} catch (std::exception &e) {
+				delete[] m_Data;
+				throw;
+			}
+		}
+
+		// move constructor
+		MatrixStorage(MatrixStorage&& rhs) noexcept : m_Columns{rhs.m_Columns},
+				m_Rows{rhs.m_Rows}, m_Size{rhs.m_Size}, m_Data{rhs.m_Data} {
+			rhs.m_Data = nullptr;
+		}
+
+		// assignment operator implemented by swapping buffers
+		MatrixStorage& operator=(MatrixStorage const& rhs) {
+			if (this == &rhs)
+				return *this;
+
+			T *copy = new T[rhs.m_Size];
+
+			try {
+				std::copy(&rhs.m_Data[0], &rhs.m_Data[rhs.m_Size], &copy[0]);
+			} catch (std::exception &e) {
+				delete[] copy;
+				throw;
+			}
+
+			m_Columns = rhs.m_Columns;
+			m_Rows = rhs.m_Rows;
+			m_Size = m_Columns * m_Rows;
+			delete[] m_Data;
+			m_Data = copy;
+
+			return *this;
+		}
+
+		// move assignment operator
+		MatrixStorage& operator=(MatrixStorage&& rhs) noexcept {
+			std::swap(m_Columns, rhs.m_Columns);
+			std::swap(m_Rows, rhs.m_Rows);
+			std::swap(m_Size, rhs.m_Size);
+			std::swap(m_Data, rhs.m_Data);
+
+			return *this;
+		}
+
+		~MatrixStorage() noexcept { delete[] m_Data; }
+
+		size_type NumColumns() const { return m_Columns; }
+		size_type NumRows() const { return m_Rows; }
+		size_type Size() const { return m_Size; }
+
+		T* Data() noexcept { return m_Data; }
+		T const* Data() const noexcept { return m_Data; }
+
+	private:
+		size_type m_Columns, m_Rows, m_Size;
+		T* m_Data;
+};
+
+}	// Miner
+
+#endif
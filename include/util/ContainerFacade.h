@@ -42,12 +42,12 @@ class ContainerFacade {
 		ContainerFacade() : m_Container{} {}
 		ContainerFacade(size_type capacity) : m_Container(capacity) {}
 		ContainerFacade(ContainerFacade const& rhs) : m_Container{rhs.m_Container} {}
-		ContainerFacade(ContainerFacade&& rhs) : m_Container{std::move(rhs.m_Container)} {}
+		ContainerFacade(ContainerFacade&& rhs) noexcept : m_Container{std::move(rhs.m_Container)} {}
 		ContainerFacade& operator=(ContainerFacade const& rhs) {
 			m_Container = rhs.m_Container;
 			return *this;
 		}
-		ContainerFacade& operator=(ContainerFacade&& rhs) {
+		ContainerFacade& operator=(ContainerFacade&& rhs) noexcept {
 			m_Container = std::move(rhs.m_Container);
 			return *this;
 		}
@@ -73,13 +73,13 @@ class RAContainerFacade : public ContainerFacade<T, C> {
 		RAContainerFacade() = default;
 		RAContainerFacade(size_type capacity) : ContainerFacade<T, C>{capacity} {}
 		RAContainerFacade(RAContainerFacade const& rhs) : ContainerFacade<T, C>{rhs} {}
-		RAContainerFacade(RAContainerFacade&& rhs) : ContainerFacade<T, C>{rhs} {}
+		RAContainerFacade(RAContainerFacade&& rhs) noexcept : ContainerFacade<T, C>{std::move(rhs)} {}
 		RAContainerFacade& operator=(RAContainerFacade const& rhs) {
 			ContainerFacade<T, C>::operator=(rhs);
 			return *this;
 		}
-		RAContainerFacade& operator=(RAContainerFacade&& rhs) {
-			ContainerFacade<T, C>::operator=(rhs);
+		RAContainerFacade& operator=(RAContainerFacade&& rhs) noexcept {
+			ContainerFacade<T, C>::operator=(std::move(rhs));
 			return *this;
 		}
 };
@@ -6,12 +6,29 @@
 #ifndef UTIL_RANDOM_H__
 #define UTIL_RANDOM_H__
 
+#include <random>
+#include <iterator>
+
 namespace Util {
 
+// the engine shared by all of the functions below
+std::default_random_engine& rand_generator();
+
 double rand_between(double min, double max);
 float rand_between(float min, float max);
 int rand_between(int min, int max);
 
+// fills in [first, last) with ints in [min, max] using a single distribution
+template <typename It>
+void rand_between(int min, int max, It first, It last) {
+	typedef typename std::iterator_traits<It>::value_type value_type;
+	std::uniform_int_distribution<int> distribution(min, max);
+	std::default_random_engine& generator = rand_generator();
+
+	for (; first != last; ++first)
+		*first = static_cast<value_type>(distribution(generator));
+}
+
 }	// Util
 
 #endif
@@ -0,0 +1,59 @@
+/* SPSCQueue.h - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * A fixed capacity, lock-free queue for exactly one producer thread and one
+ * consumer thread. Capacity must be a power of two.
+ */
+
+#ifndef UTIL_SPSCQUEUE_H__
+#define UTIL_SPSCQUEUE_H__
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace Util {
+
+template <typename T, std::size_t N>
+class SPSCQueue {
+	static_assert(N > 0 && (N & (N - 1)) == 0, "SPSCQueue capacity must be a power of two!");
+
+	public:
+		SPSCQueue() : m_Items(), m_Head{0}, m_Tail{0} {}
+
+		SPSCQueue(SPSCQueue const& rhs) = delete;
+		SPSCQueue& operator=(SPSCQueue const& rhs) = delete;
+
+		// producer side, returns false if the queue is full
+		bool Push(T const& item) {
+			std::size_t const tail = m_Tail.load(std::memory_order_relaxed);
+
+			if (tail - m_Head.load(std::memory_order_acquire) == N)
+				return false;
+
+			m_Items[tail & (N - 1)] = item;
+			m_Tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// consumer side, returns false if the queue is empty
+		bool Pop(T& item) {
+			std::size_t const head = m_Head.load(std::memory_order_relaxed);
+
+			if (head == m_Tail.load(std::memory_order_acquire))
+				return false;
+
+			item = m_Items[head & (N - 1)];
+			m_Head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+	private:
+		std::array<T, N> m_Items;
+		// counters only ever grow, wrapping around is fine for unsigned
+		std::atomic<std::size_t> m_Head;
+		std::atomic<std::size_t> m_Tail;
+};
+
+}	// Util
+
+#endif
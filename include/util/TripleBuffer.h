@@ -0,0 +1,65 @@
+/* TripleBuffer.h - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * Lock-free hand over of whole values from one writer thread to one reader
+ * thread. The writer fills Back() and calls Publish(), the reader calls
+ * Acquire() and reads Front(). Neither side ever waits for the other, and the
+ * reader always gets the most recently published value, skipping any it
+ * didn't get to see.
+ *
+ * The three buffers are reused, so Back() holds stale data from some earlier
+ * publication and must be filled in completely.
+ */
+
+#ifndef UTIL_TRIPLEBUFFER_H__
+#define UTIL_TRIPLEBUFFER_H__
+
+#include <array>
+#include <atomic>
+
+namespace Util {
+
+template <typename T>
+class TripleBuffer {
+	public:
+		TripleBuffer() : m_Buffers(), m_Back{0}, m_Shared{1}, m_Front{2} {}
+
+		TripleBuffer(TripleBuffer const& rhs) = delete;
+		TripleBuffer& operator=(TripleBuffer const& rhs) = delete;
+
+		// writer side
+		T& Back() { return m_Buffers[m_Back]; }
+
+		void Publish() {
+			m_Back = m_Shared.exchange(m_Back | FreshBit) & IndexMask;
+		}
+
+		// reader side, true if there is something newer than Front()
+		bool Fresh() const {
+			return (m_Shared.load() & FreshBit) != 0;
+		}
+
+		// swaps in the latest published value, returns false if there was none
+		bool Acquire() {
+			if (!Fresh())
+				return false;
+
+			m_Front = m_Shared.exchange(m_Front) & IndexMask;
+			return true;
+		}
+
+		T const& Front() const { return m_Buffers[m_Front]; }
+
+	private:
+		static constexpr unsigned int IndexMask = 3;
+		static constexpr unsigned int FreshBit = 4;
+
+		std::array<T, 3> m_Buffers;
+		unsigned int m_Back;
+		// index of the buffer in between, plus whether the writer left it there
+		std::atomic<unsigned int> m_Shared;
+		unsigned int m_Front;
+};
+
+}	// Util
+
+#endif
@@ -2,7 +2,7 @@
  *
  * Singleton asset manager for the game.
  *
- * Its data is tied to the texture atlas used.
+ * Its data is tied to the texture atlas used, see AtlasManifest.h.
  */
 
 #include "engine/Graphics.h"
@@ -10,34 +10,104 @@
 #include "engine/TextureRegion.h"
 #include "engine/Animation.h"
 #include "engine/Font.h"
+#include "engine/RotationCache.h"
+#include "engine/ScaleCache.h"
+#include "engine/ImageLoader.h"
+
+#include "AtlasManifest.h"
 
 #include "Assets.h"
 
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 using Engine::Graphics;
 using Engine::Texture;
 using Engine::TextureRegion;
 using Engine::Animation;
 using Engine::Font;
+using Engine::RotationCache;
+using Engine::ScaleCache;
+
+#ifdef EMBED_ASSETS
+// linked in from bin/resources.o, see EMBED in the Makefile
+#ifdef EMBED_DECODED
+#define EMBEDDED(symbol, part) _binary_##symbol##_texcache_##part
+#else
+#define EMBEDDED(symbol, part) _binary_##symbol##_##part
+#endif
+#define DECLARE_PAGE(symbol, file) \
+	extern "C" char const EMBEDDED(symbol, start)[], EMBEDDED(symbol, end)[];
+ATLASMANIFEST_PAGES(DECLARE_PAGE)
+#undef DECLARE_PAGE
+#endif
 
 Assets* Assets::instance = nullptr;
 
-Assets::Assets()
+Assets::Assets() : loadTimes{}
 {
-	background = new Texture("../res/BackGround.jpg");
-	backgroundRegion = new TextureRegion(background, 0, 0, background->Width(), background->Height());
-	atlas = new Texture("../res/textureatlas.png");
-	jewelYellow = new TextureRegion(atlas, 0, 0, 40, 40);
-	jewelRed = new TextureRegion(atlas, 40, 0, 40, 40);
-	jewelPurple = new TextureRegion(atlas, 80, 0, 40, 40);
-	jewelGreen = new TextureRegion(atlas, 120, 0, 40, 40);
-	jewelBlue = new TextureRegion(atlas, 160, 0, 40, 40);
-	star = new TextureRegion(atlas, 64, 64, 32, 30);
-	font = new Font(atlas, 224, 0, 16, 16, 20);
-	spark1 = new TextureRegion(atlas, 0, 128, 20, 20);
-	spark2 = new TextureRegion(atlas, 22, 128, 20, 20);
-	spark3 = new TextureRegion(atlas, 44, 128, 20, 20);
-	spark4 = new TextureRegion(atlas, 66, 128, 20, 20);
+	std::vector<Engine::ImageLoader::Source> sources;
+
+#ifdef EMBED_ASSETS
+#define EMBEDDED_PAGE(symbol, file) \
+	sources.emplace_back(file, EMBEDDED(symbol, start), \
+			EMBEDDED(symbol, end) - EMBEDDED(symbol, start));
+	ATLASMANIFEST_PAGES(EMBEDDED_PAGE)
+#undef EMBEDDED_PAGE
+#else
+	for (auto const page : AtlasManifest::pages)
+		sources.emplace_back(std::string("../res/") + page);
+#endif
+
+	// regions only need the textures to exist, not their pixels
+	for (auto& page : pages)
+		page = new Texture();
+
+	backgroundRegion = Region(AtlasManifest::background);
+	jewelYellow = Region(AtlasManifest::jewelYellow);
+	jewelRed = Region(AtlasManifest::jewelRed);
+	jewelPurple = Region(AtlasManifest::jewelPurple);
+	jewelGreen = Region(AtlasManifest::jewelGreen);
+	jewelBlue = Region(AtlasManifest::jewelBlue);
+	star = Region(AtlasManifest::star);
+	// 96 glyphs, 16 per row, each 16x20
+	fontRegion = Region(AtlasManifest::font);
+	font = new Font(pages[AtlasManifest::font.page], AtlasManifest::font.x, AtlasManifest::font.y, 16, 16, 20);
+	spark1 = Region(AtlasManifest::spark1);
+	spark2 = Region(AtlasManifest::spark2);
+	spark3 = Region(AtlasManifest::spark3);
+	spark4 = Region(AtlasManifest::spark4);
 	spark = new Animation(0.05, Animation::Mode::Looping, std::vector<TextureRegion*>{spark1, spark2, spark3, spark4});
+	rotations = nullptr;
+
+	// jewels shrink with the board, and text can be drawn small
+	std::vector<ScaleCache::Page> sizes;
+	for (std::size_t i = 0; i < pages.size(); ++i)
+		sizes.push_back(ScaleCache::Page{ pages[i], AtlasManifest::pageSizes[i].w, AtlasManifest::pageSizes[i].h });
+	scales = new ScaleCache(sizes, std::vector<ScaleCache::Source>{
+			jewelYellow, jewelRed, jewelPurple, jewelGreen, jewelBlue, star,
+			ScaleCache::Source{fontRegion, 16, 20}
+		});
+
+	// the copies get rendered by the workers, and cached along with the pages
+	for (std::size_t i = 0; i < pages.size(); ++i) {
+		Texture const* page = pages[i];
+		ScaleCache const* scaled = scales;
+
+		sources[i].prepare = Texture::Prepare{
+			[page, scaled] (SDL_Surface *surface, bool prepared) {
+				return scaled->Extend(page, surface, prepared);
+			}, scales->Key(page) };
+	}
+
+	// loaders are initialized here so that workers don't race to do it
+	IMG_Init(IMG_INIT_PNG);
+	mp_Loader = new Engine::ImageLoader(sources);
 }
 
 Assets::Assets(Assets const& rhs)
@@ -56,10 +126,10 @@ Assets& Assets::operator=(Assets const& rhs)
 
 Assets::~Assets()
 {
-	delete background;
 	delete backgroundRegion;
 	delete star;
 	delete font;
+	delete fontRegion;
 	delete jewelYellow;
 	delete jewelRed;
 	delete jewelPurple;
@@ -69,7 +139,17 @@ Assets::~Assets()
 	delete spark2;
 	delete spark3;
 	delete spark4;
-	delete atlas;
+	delete mp_Loader;
+	delete rotations;
+	delete scales;
+	for (auto page : pages)
+		delete page;
+}
+
+// a region of the atlas, as placed by the packer
+TextureRegion* Assets::Region(AtlasManifest::Region const& region)
+{
+	return new TextureRegion(pages[region.page], region.x, region.y, region.w, region.h);
 }
 
 Assets& Assets::Instance() {
@@ -79,8 +159,39 @@ Assets& Assets::Instance() {
 	return *instance;
 }
 
-// helper needed to set renderer on textures
-void Assets::SetGraphics(Graphics const& g) {
-	background->SetRenderer(g.GetRenderer());
-	atlas->SetRenderer(g.GetRenderer());
+// waits for images, with their scaled down copies, and uploads them
+void Assets::SetGraphics(Graphics const& g) noexcept(false) {
+	Uint64 const start = SDL_GetPerformanceCounter();
+	double const frequency = SDL_GetPerformanceFrequency();
+
+	if (mp_Loader != nullptr) {
+		for (std::size_t i = 0; i < pages.size(); ++i) {
+			pages[i]->Adopt(mp_Loader->Take(i));
+			loadTimes.decode = std::max(loadTimes.decode, mp_Loader->DecodeTime(i));
+		}
+		delete mp_Loader;
+		mp_Loader = nullptr;
+	}
+
+	Uint64 const decoded = SDL_GetPerformanceCounter();
+
+	// the CPU blitter reads pixels straight from the surfaces
+	for (auto page : pages)
+		page->SetRenderer(g.GetRenderer(), g.UsingBlitter());
+
+	loadTimes.wait = (decoded - start) / frequency;
+	loadTimes.upload = (SDL_GetPerformanceCounter() - decoded) / frequency;
+}
+
+// pre-renders spinning sprites at steps angles, only on the software renderer
+void Assets::CacheRotations(Graphics& g, int steps) {
+	if (rotations != nullptr || steps < 2)
+		return;
+
+	if (!g.SoftwareRenderer() || !g.RenderTargetSupported())
+		return;
+
+	rotations = new RotationCache(g, std::vector<TextureRegion const*>{
+			jewelYellow, jewelRed, jewelPurple, jewelGreen, jewelBlue, star
+		}, steps);
 }
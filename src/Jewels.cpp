@@ -0,0 +1,310 @@
+/* Jewels.cpp - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * The jewels that get drawn to screen, all of them in one store.
+ */
+
+#include "util/Random.h"
+
+#include "miner/Jewel.h"
+
+#include "engine/GameObject.h"
+#include "engine/TextureRegion.h"
+#include "engine/Vector2.h"
+
+#include "Assets.h"
+#include "Stars.h"
+
+#include "Jewels.h"
+
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+Jewels::Jewels(int numcells, Stars *stars) :
+		m_Slots(numcells), m_Motion(numcells), m_Look(numcells), mp_Stars{stars},
+		m_Active{}, m_ActiveAt(numcells), m_Animating{0}
+{
+	m_Active.reserve(numcells);
+	Reset();
+}
+
+// puts every jewel back at its own cell, at rest, unselected and colorless
+void Jewels::Reset()
+{
+	for (std::vector<int>::size_type i = 0; i < m_Slots.size(); ++i) {
+		m_Slots[i] = i;
+		m_Motion[i] = Motion{ Engine::Vector2<double>{}, Engine::Vector2<double>{},
+			Engine::Vector2<double>{}, Engine::Vector2<double>{}, Engine::Vector2<double>{},
+			0, 0, 0, 0, false, false, false };
+		m_Look[i] = Look{ nullptr, Miner::Jewel::Color::None, 0, 0, false };
+		m_ActiveAt[i] = -1;
+	}
+
+	m_Active.clear();
+	m_Animating = 0;
+}
+
+// swaps the jewels of two cells
+void Jewels::Swap(int cell1, int cell2)
+{
+	std::swap(m_Slots[cell1], m_Slots[cell2]);
+}
+
+void Jewels::SetColor(int cell, Miner::Jewel::Color color)
+{
+	Look& look = m_Look[m_Slots[cell]];
+
+	look.color = color;
+	look.region = GetJewelRegion(color);
+}
+
+void Jewels::Size(int cell, int width, int height)
+{
+	Look& look = m_Look[m_Slots[cell]];
+
+	look.width = width;
+	look.height = height;
+}
+
+// jumps to a position, without interpolating
+void Jewels::SetPosition(int cell, Engine::Vector2<double> const& position)
+{
+	Motion& motion = m_Motion[m_Slots[cell]];
+
+	motion.position = position;
+	motion.prevPosition = position;
+}
+
+// moves towards target, starting at vel and speeding up by accel
+void Jewels::MoveTo(int cell, Engine::Vector2<double> const& target, double vel, double accel)
+{
+	int const slot = m_Slots[cell];
+	Motion& motion = m_Motion[slot];
+
+	motion.targetMode = true;
+	motion.target = target;
+	motion.velocity = (motion.target - motion.position).Nor();
+	motion.accel = motion.velocity * accel;
+	motion.velocity *= vel;
+	Wake(slot);
+}
+
+// spins for time seconds, then turns into stars
+void Jewels::Explode(int cell, double time, double vel, double accel)
+{
+	int const slot = m_Slots[cell];
+	Motion& motion = m_Motion[slot];
+
+	motion.exploding = true;
+	motion.explodingTime = time;
+	motion.angularVel = vel;
+	motion.angularAccel = accel;
+	Wake(slot);
+}
+
+// skips to the end of any movement or explosion, ie. when out of sight
+void Jewels::Finish(int cell)
+{
+	int const slot = m_Slots[cell];
+	Motion& motion = m_Motion[slot];
+
+	if (motion.targetMode) {
+		motion.position = motion.target;
+		motion.velocity.Set(0, 0);
+		motion.accel.Set(0, 0);
+		motion.targetMode = false;
+	}
+
+	// nobody would see the stars either
+	if (motion.exploding)
+		Exploded(slot, false);
+
+	// no settling step left either
+	motion.prevPosition = motion.position;
+	Sleep(slot);
+}
+
+// toggles the selection, scaling the jewel up or back down
+void Jewels::Select(int cell)
+{
+	Look& look = m_Look[m_Slots[cell]];
+	double const scale = look.selected ? 1.0/1.2 : 1.2;
+
+	look.selected = !look.selected;
+	look.width *= scale;
+	look.height *= scale;
+}
+
+// steps the active jewels only
+void Jewels::Update(double deltatime)
+{
+	for (std::vector<int>::size_type i = 0; i < m_Active.size(); ) {
+		int const slot = m_Active[i];
+		Motion& motion = m_Motion[slot];
+
+		// same as Engine::DynamicGameObject::Update()
+		motion.prevPosition = motion.position;
+		motion.velocity += motion.accel * deltatime;
+		motion.position += motion.velocity * deltatime;
+		if (motion.targetMode) {
+			// this check does not compare to zero to make for potential precision loss
+			if (std::abs(motion.velocity.Angle() - (motion.target - motion.position).Angle()) > 0.001) {
+				motion.position = motion.target;
+				motion.velocity.Set(0, 0);
+				motion.accel.Set(0, 0);
+				motion.targetMode = false;
+			}
+		}
+
+		if (motion.angularAccel != 0)
+			motion.angularVel += motion.angularAccel * deltatime;
+		if (motion.angularVel != 0)
+			motion.angle += remainder(motion.angularVel * deltatime, 360.0);
+
+		if (motion.exploding) {
+			motion.explodingTime -= deltatime;
+			if (motion.explodingTime < 0)
+				Exploded(slot, true);
+		}
+
+		if (!Stopped(motion)) {
+			++i;
+			continue;
+		}
+
+		if (motion.animating) {
+			motion.animating = false;
+			--m_Animating;
+		}
+
+		// it has arrived, but stays one more step to settle where drawn
+		if (motion.prevPosition.X() != motion.position.X() ||
+				motion.prevPosition.Y() != motion.position.Y()) {
+			++i;
+			continue;
+		}
+
+		// the last active slot takes its place
+		Sleep(slot);
+	}
+}
+
+bool Jewels::Stopped(int cell) const
+{
+	return Stopped(m_Motion[m_Slots[cell]]);
+}
+
+// whether the last update changed the position
+bool Jewels::Moved(int cell) const
+{
+	Motion const& motion = m_Motion[m_Slots[cell]];
+
+	return motion.prevPosition.X() != motion.position.X() ||
+		motion.prevPosition.Y() != motion.position.Y();
+}
+
+// not moving, spinning nor exploding, so it can be drawn from a cache
+bool Jewels::Settled(int cell) const
+{
+	return Stopped(cell) && !Moved(cell) && m_Motion[m_Slots[cell]].angle == 0;
+}
+
+// copies what is needed to draw the jewel of a cell
+void Jewels::Get(int cell, Engine::GameObject& object) const
+{
+	int const slot = m_Slots[cell];
+	Motion const& motion = m_Motion[slot];
+	Look const& look = m_Look[slot];
+
+	object.SetPosition(motion.position, motion.prevPosition);
+	object.Size(look.width, look.height);
+	object.Angle(motion.angle);
+	object.Region(look.region);
+}
+
+// puts a slot in the active set, counting it as animating
+void Jewels::Wake(int slot)
+{
+	Motion& motion = m_Motion[slot];
+
+	if (!motion.animating) {
+		motion.animating = true;
+		++m_Animating;
+	}
+
+	if (m_ActiveAt[slot] < 0) {
+		m_ActiveAt[slot] = m_Active.size();
+		m_Active.push_back(slot);
+	}
+}
+
+// takes a slot out of the active set
+void Jewels::Sleep(int slot)
+{
+	Motion& motion = m_Motion[slot];
+	int const at = m_ActiveAt[slot];
+
+	if (motion.animating) {
+		motion.animating = false;
+		--m_Animating;
+	}
+
+	if (at < 0)
+		return;
+
+	m_Active[at] = m_Active.back();
+	m_ActiveAt[m_Active[at]] = at;
+	m_Active.pop_back();
+	m_ActiveAt[slot] = -1;
+}
+
+bool Jewels::Stopped(Motion const& motion)
+{
+	return !motion.exploding && motion.velocity.X() == 0 && motion.velocity.Y() == 0;
+}
+
+// turns an exploding jewel into nothing, and some stars if asked to
+void Jewels::Exploded(int slot, bool stars)
+{
+	Motion& motion = m_Motion[slot];
+	Look& look = m_Look[slot];
+
+	motion.exploding = false;
+	motion.angularAccel = 0;
+	motion.angularVel = 0;
+	motion.angle = 0;
+	look.color = Miner::Jewel::Color::None;
+	look.region = nullptr;
+
+	// Exploded! Now generate some stars
+	if (stars && mp_Stars != nullptr)
+		mp_Stars->Spawn(motion.position.X(), motion.position.Y(), Util::rand_between(5, 10));
+}
+
+Engine::TextureRegion const* Jewels::GetJewelRegion(Miner::Jewel::Color color)
+{
+	Engine::TextureRegion const *region;
+
+	switch (color) {
+	case Miner::Jewel::Color::Red:
+		region = Assets::Instance().jewelRed;
+		break;
+	case Miner::Jewel::Color::Yellow:
+		region = Assets::Instance().jewelYellow;
+		break;
+	case Miner::Jewel::Color::Green:
+		region = Assets::Instance().jewelGreen;
+		break;
+	case Miner::Jewel::Color::Blue:
+		region = Assets::Instance().jewelBlue;
+		break;
+	case Miner::Jewel::Color::Purple:
+		region = Assets::Instance().jewelPurple;
+		break;
+	case Miner::Jewel::Color::None:
+	default:
+		region = nullptr;
+	}
+	return region;
+}
@@ -0,0 +1,168 @@
+/* Simulation.cpp - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * Runs the simulation half of a World on its own thread, in fixed steps, so
+ * that a slow Present() doesn't hold back the game logic and a long cascade
+ * doesn't hold back drawing.
+ */
+
+#include <SDL2/SDL.h>
+
+#include "util/SPSCQueue.h"
+#include "util/TripleBuffer.h"
+
+#include "Snapshot.h"
+#include "World.h"
+
+#include "Simulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+Simulation::Simulation(World& world, int tickrate) noexcept(false) :
+		m_World(world), m_Step{1.0 / tickrate},
+		m_Frequency{static_cast<double>(SDL_GetPerformanceFrequency())},
+		m_Snapshots{}, m_Input{}, mp_Wakeup{nullptr},
+		m_Quit{false}, m_Waiting{false}, mp_Thread{nullptr}
+{
+	mp_Wakeup = SDL_CreateSemaphore(0);
+	if (mp_Wakeup == nullptr)
+		throw std::runtime_error(SDL_GetError());
+
+	// have something to draw right away
+	Publish(SDL_GetPerformanceCounter());
+	m_Snapshots.Acquire();
+
+	mp_Thread = SDL_CreateThread(Simulation::Run, "Simulation", this);
+	if (mp_Thread == nullptr) {
+		SDL_DestroySemaphore(mp_Wakeup);
+		throw std::runtime_error(SDL_GetError());
+	}
+}
+
+Simulation::~Simulation()
+{
+	m_Quit = true;
+	SDL_SemPost(mp_Wakeup);
+	SDL_WaitThread(mp_Thread, nullptr);
+	SDL_DestroySemaphore(mp_Wakeup);
+}
+
+int Simulation::Run(void *data)
+{
+	static_cast<Simulation*>(data)->Loop();
+	return 0;
+}
+
+void Simulation::Loop()
+{
+	// don't try to catch up on more than this, ie. after a long sleep
+	double const maxelapsed = 0.25;
+	double accumulator = 0;
+	Uint64 starttime = SDL_GetPerformanceCounter();
+
+	while (!m_Quit) {
+		bool changed = false;
+		Input input;
+
+		while (m_Input.Pop(input)) {
+			switch (input.type) {
+			case Input::Click:
+				m_World.Click(input.x, input.y, input.value != 0);
+				break;
+			case Input::Zoom:
+				m_World.Zoom(input.x, input.y, input.value);
+				break;
+			case Input::Pan:
+				m_World.Pan(input.x, input.y);
+				break;
+			}
+			changed = true;
+		}
+
+		Uint64 currenttime = SDL_GetPerformanceCounter();
+		accumulator += std::min((currenttime - starttime) / m_Frequency, maxelapsed);
+		starttime = currenttime;
+		while (accumulator >= m_Step) {
+			m_World.Update(m_Step);
+			accumulator -= m_Step;
+			changed = true;
+		}
+
+		if (changed)
+			Publish(currenttime - static_cast<Uint64>(accumulator * m_Frequency));
+
+		// sleep until the next step is due, or the next change if later
+		double const next = m_World.NextChange();
+		if (next < 0) {
+			SDL_SemWait(mp_Wakeup);
+			// nothing was due while idle, so there is nothing to catch up on
+			starttime = SDL_GetPerformanceCounter();
+			accumulator = 0;
+		} else {
+			double const wait = std::max(next, m_Step - accumulator);
+			SDL_SemWaitTimeout(mp_Wakeup, static_cast<Uint32>(std::ceil(wait * 1000)));
+		}
+	}
+}
+
+void Simulation::Publish(Uint64 statetime)
+{
+	Snapshot& snapshot = m_Snapshots.Back();
+
+	m_World.Publish(snapshot);
+	snapshot.time = statetime;
+	m_Snapshots.Publish();
+
+	// the main thread might be sleeping with nothing new to draw
+	if (m_Waiting.exchange(false)) {
+		SDL_Event e;
+		SDL_zero(e);
+		e.type = SDL_USEREVENT;
+		SDL_PushEvent(&e);
+	}
+}
+
+void Simulation::Push(Input const& input)
+{
+	// if full, the player is clicking way faster than we can keep up with
+	if (m_Input.Push(input))
+		SDL_SemPost(mp_Wakeup);
+}
+
+void Simulation::Click(int x, int y, bool up)
+{
+	Push(Input{Input::Click, x, y, up});
+}
+
+void Simulation::Zoom(int x, int y, int steps)
+{
+	Push(Input{Input::Zoom, x, y, steps});
+}
+
+void Simulation::Pan(int dx, int dy)
+{
+	Push(Input{Input::Pan, dx, dy, 0});
+}
+
+int Simulation::WaitEvent(SDL_Event& e)
+{
+	m_Waiting = true;
+	// a snapshot published before we flagged waiting would not wake us up
+	if (m_Snapshots.Fresh()) {
+		m_Waiting = false;
+		return 0;
+	}
+
+	int const res = SDL_WaitEvent(&e);
+	m_Waiting = false;
+
+	return res;
+}
+
+double Simulation::Blend() const
+{
+	double const elapsed = (SDL_GetPerformanceCounter() - Current().time) / m_Frequency;
+
+	return std::min(std::max(elapsed / m_Step, 0.0), 1.0);
+}
@@ -11,6 +11,7 @@
 
 #include "Spark.h"
 
+#include <cmath>
 #include <vector>
 
 Spark::Spark(double time) : mp_Anim{Assets::Instance().spark},
@@ -23,7 +24,7 @@ Spark::Spark(double time) : mp_Anim{Assets::Instance().spark},
 			Engine::Vector2<double>(178, 372),
 		}
 {
-	m_Position.Set(262, 555);
+	SetPosition(262, 555);
 	m_Velocity = Spark::distance / time;
 }
 
@@ -44,9 +45,27 @@ void Spark::Update(double deltatime)
 	m_Height = mp_Region->Height();
 }
 
+// seconds until the spark next changes its look or heads to another waypoint
+double Spark::NextChange() const
+{
+	double next = mp_Anim->NextKeyFrame(acctime);
+
+	if (!m_Done) {
+		Engine::Vector2<double> const& waypoint = coords[i];
+		double const dx = waypoint.X() - m_Position.X();
+		double const dy = waypoint.Y() - m_Position.Y();
+		double const arrival = std::sqrt(dx * dx + dy * dy) / m_Velocity;
+
+		if (next < 0 || arrival < next)
+			next = arrival;
+	}
+
+	return next;
+}
+
 // useful to reuse this instance
 void Spark::Reset() {
-	m_Position.Set(262, 555);
+	SetPosition(262, 555);
 	m_Done = false;
 	i = 0;
 	acctime = 0;
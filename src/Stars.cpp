@@ -0,0 +1,160 @@
+/* Stars.cpp - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * The rotating, popping and fading stars that get ejected when jewels
+ * "explode", all of them in one pool.
+ */
+
+#include "engine/Graphics.h"	// for GRect
+
+#include "util/Random.h"
+
+#include "Stars.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+Stars::Stars() : m_Fields{}
+{
+	for (auto& field : m_Fields)
+		field.reserve(capacity);
+}
+
+// ejects count stars from x, y
+void Stars::Spawn(double x, double y, int count)
+{
+	std::size_t const first = Size();
+
+	if (count <= 0 || first >= capacity)
+		return;
+
+	std::size_t const last = first + std::min<std::size_t>(count, capacity - first);
+
+	for (auto& field : m_Fields)
+		field.resize(last);
+
+	// all the random numbers of a burst, a field at a time
+	float *const spin = &m_Fields[AngularVel][first];
+	Util::rand_between(0, 1, spin, spin + (last - first));
+	Util::rand_between(4, maxWidth, &m_Fields[Sides][first], &m_Fields[Sides][first] + (last - first));
+	Util::rand_between(20, maxIniVelX, &m_Fields[VelX][first], &m_Fields[VelX][first] + (last - first));
+	Util::rand_between(100, maxIniVelY, &m_Fields[VelY][first], &m_Fields[VelY][first] + (last - first));
+
+	for (std::size_t i = first; i < last; ++i) {
+		float const rotation = m_Fields[AngularVel][i] != 0 ? 1 : -1;
+
+		m_Fields[X][i] = m_Fields[PrevX][i] = x;
+		m_Fields[Y][i] = m_Fields[PrevY][i] = y;
+		m_Fields[VelX][i] *= rotation;
+		m_Fields[VelY][i] = -m_Fields[VelY][i];
+		m_Fields[Angles][i] = 0;
+		m_Fields[AngularVel][i] = angularVel * rotation;
+		m_Fields[Alphas][i] = 1;
+	}
+}
+
+void Stars::Update(double deltatime)
+{
+	float const dt = deltatime;
+	float const dv = gravity * deltatime;
+	float const fade = deltatime / fadeTime;
+	std::size_t const n = Size();
+
+	float *const x = m_Fields[X].data();
+	float *const y = m_Fields[Y].data();
+	float *const prevx = m_Fields[PrevX].data();
+	float *const prevy = m_Fields[PrevY].data();
+	float *const velx = m_Fields[VelX].data();
+	float *const vely = m_Fields[VelY].data();
+	float *const angle = m_Fields[Angles].data();
+	float const* const angularvel = m_Fields[AngularVel].data();
+	float *const alpha = m_Fields[Alphas].data();
+	std::size_t i = 0;
+
+	// stars fade out well before turning around, so angles never wrap
+#if defined(__AVX2__)
+	__m256 const dt8 = _mm256_set1_ps(dt);
+	__m256 const dv8 = _mm256_set1_ps(dv);
+	__m256 const fade8 = _mm256_set1_ps(fade);
+	__m256 const zero = _mm256_setzero_ps();
+
+	for (; i + 8 <= n; i += 8) {
+		__m256 const px = _mm256_loadu_ps(x + i);
+		__m256 const py = _mm256_loadu_ps(y + i);
+		__m256 const vy = _mm256_add_ps(_mm256_loadu_ps(vely + i), dv8);
+
+		_mm256_storeu_ps(prevx + i, px);
+		_mm256_storeu_ps(prevy + i, py);
+		_mm256_storeu_ps(vely + i, vy);
+		_mm256_storeu_ps(x + i, _mm256_add_ps(px, _mm256_mul_ps(_mm256_loadu_ps(velx + i), dt8)));
+		_mm256_storeu_ps(y + i, _mm256_add_ps(py, _mm256_mul_ps(vy, dt8)));
+		_mm256_storeu_ps(angle + i, _mm256_add_ps(_mm256_loadu_ps(angle + i),
+			_mm256_mul_ps(_mm256_loadu_ps(angularvel + i), dt8)));
+		_mm256_storeu_ps(alpha + i, _mm256_max_ps(_mm256_sub_ps(_mm256_loadu_ps(alpha + i), fade8), zero));
+	}
+#elif defined(__SSE2__)
+	__m128 const dt4 = _mm_set1_ps(dt);
+	__m128 const dv4 = _mm_set1_ps(dv);
+	__m128 const fade4 = _mm_set1_ps(fade);
+	__m128 const zero = _mm_setzero_ps();
+
+	for (; i + 4 <= n; i += 4) {
+		__m128 const px = _mm_loadu_ps(x + i);
+		__m128 const py = _mm_loadu_ps(y + i);
+		__m128 const vy = _mm_add_ps(_mm_loadu_ps(vely + i), dv4);
+
+		_mm_storeu_ps(prevx + i, px);
+		_mm_storeu_ps(prevy + i, py);
+		_mm_storeu_ps(vely + i, vy);
+		_mm_storeu_ps(x + i, _mm_add_ps(px, _mm_mul_ps(_mm_loadu_ps(velx + i), dt4)));
+		_mm_storeu_ps(y + i, _mm_add_ps(py, _mm_mul_ps(vy, dt4)));
+		_mm_storeu_ps(angle + i, _mm_add_ps(_mm_loadu_ps(angle + i),
+			_mm_mul_ps(_mm_loadu_ps(angularvel + i), dt4)));
+		_mm_storeu_ps(alpha + i, _mm_max_ps(_mm_sub_ps(_mm_loadu_ps(alpha + i), fade4), zero));
+	}
+#endif
+
+	for (; i < n; ++i) {
+		prevx[i] = x[i];
+		prevy[i] = y[i];
+		vely[i] += dv;
+		x[i] += velx[i] * dt;
+		y[i] += vely[i] * dt;
+		angle[i] += angularvel[i] * dt;
+		alpha[i] = std::max(alpha[i] - fade, 0.0f);
+	}
+
+	// the last live star takes the place of each faded one
+	for (i = 0; i < Size(); ) {
+		if (m_Fields[Alphas][i] > 0) {
+			++i;
+			continue;
+		}
+
+		for (auto& field : m_Fields) {
+			field[i] = field.back();
+			field.pop_back();
+		}
+	}
+}
+
+// rectangle of a star at blend (0 to 1) between its last two positions
+Engine::GRect Stars::Rect(std::size_t star, double blend) const
+{
+	double const x = m_Fields[PrevX][star] + (m_Fields[X][star] - m_Fields[PrevX][star]) * blend;
+	double const y = m_Fields[PrevY][star] + (m_Fields[Y][star] - m_Fields[PrevY][star]) * blend;
+	int const side = m_Fields[Sides][star];
+	Engine::GRect res;
+
+	res.x = lround(x - side / 2);
+	res.y = lround(y - side / 2);
+	res.w = side;
+	res.h = side;
+
+	return res;
+}
@@ -2,19 +2,24 @@
  *
  * Manages the Jewel Miner game. Implements a Miner::Listener, keeps track
  * of the game objects, score and game life cycle.
+ *
+ * Jewels live in board space and get drawn through a camera, which only
+ * ever looks at a window of the board.
  */
 
 #include "engine/Graphics.h"
 #include "engine/Texture.h"
 #include "engine/TextureRegion.h"
 #include "engine/Font.h"
-#include "engine/SpriteBatcher.h"
+#include "engine/TextRun.h"
+#include "engine/RenderQueue.h"
+#include "engine/Camera.h"
 #include "engine/Vector2.h"
 
 #include "Assets.h"
 
-#include "Jewel.h"
-#include "Star.h"
+#include "Jewels.h"
+#include "Stars.h"
 #include "Spark.h"
 
 #include "miner/Matrix.h"
@@ -27,91 +32,374 @@
 
 #include <memory>
 #include <algorithm>
-#include <list>
 #include <string>
+#include <vector>
 
 // fills in out array with a representation of the matrix's state
 void World::AcquireMatrix()
 {
-	// m_Matrix's iterators use row order
-	std::transform(m_Matrix->cbegin(), m_Matrix->cend(), &jewels[0],
-		[this] (Miner::Jewel const& jewel) -> std::shared_ptr<Jewel> {
-			std::shared_ptr<Jewel> j(std::make_shared<Jewel>());
-			j->SetColor(jewel.GetColor());
-			j->Size(m_ShrinkedJewelWidth, m_ShrinkedJewelHeight);
-			j->SetPosition(M2S(jewel.GetColumn(), jewel.GetRow()));
-			j->SetStarList(&m_StarList);
-			return j;
-		});
-}
-
-// draws those nice jewels
-void World::DrawMatrix()
+	m_Jewels.Reset();
+	for (Miner::Jewel const& jewel : *m_Matrix) {
+		int const index = IDX(jewel.GetColumn(), jewel.GetRow());
+
+		m_Jewels.SetColor(index, jewel.GetColor());
+		m_Jewels.Size(index, m_ShrinkedJewelWidth, m_ShrinkedJewelHeight);
+		m_Jewels.SetPosition(index, M2S(jewel.GetColumn(), jewel.GetRow()));
+	}
+}
+
+// cells in view of camera, plus a margin
+Snapshot::Window World::InView(Engine::Camera const& camera)
+{
+	// jewels falling in and selected ones poke out of their cells
+	static constexpr int margin = 1;
+
+	int const col1 = std::max(static_cast<int>(camera.X() / m_JewelWidth) - margin, 0);
+	int const row1 = std::max(static_cast<int>(camera.Y() / m_JewelHeight) - margin, 0);
+	int const col2 = std::min(static_cast<int>(std::ceil((camera.X() + camera.ViewWidth()) / m_JewelWidth)) + margin, m_NumCols);
+	int const row2 = std::min(static_cast<int>(std::ceil((camera.Y() + camera.ViewHeight()) / m_JewelHeight)) + margin, m_NumRows);
+
+	return Snapshot::Window{ col1, row1, col2 - col1, row2 - row1 };
+}
+
+// cells wholly in view of camera
+Snapshot::Window World::InFullView(Engine::Camera const& camera)
+{
+	// allowing for rounding errors, ie. when zoomed out all the way
+	static constexpr double epsilon = 1e-6;
+
+	int const col1 = std::min(static_cast<int>(std::ceil(camera.X() / m_JewelWidth - epsilon)), m_NumCols);
+	int const row1 = std::min(static_cast<int>(std::ceil(camera.Y() / m_JewelHeight - epsilon)), m_NumRows);
+	int const col2 = std::max(std::min(static_cast<int>((camera.X() + camera.ViewWidth()) / m_JewelWidth + epsilon), m_NumCols), col1);
+	int const row2 = std::max(std::min(static_cast<int>((camera.Y() + camera.ViewHeight()) / m_JewelHeight + epsilon), m_NumRows), row1);
+
+	return Snapshot::Window{ col1, row1, col2 - col1, row2 - row1 };
+}
+
+// moves the window along, finishing animations of jewels left out of it
+void World::CameraMoved()
+{
+	Snapshot::Window const window = InView(m_Camera);
+
+	// jewels out of the window are never updated, so they can't be moving
+	for (int row = m_Window.row; row < m_Window.row + m_Window.rows; ++row) {
+		for (int col = m_Window.col; col < m_Window.col + m_Window.cols; ++col) {
+			if (!window.Contains(col, row))
+				m_Jewels.Finish(IDX(col, row));
+		}
+	}
+
+	m_Window = window;
+}
+
+// draws those nice jewels, except the ones already in the cache
+void World::DrawMatrix(Snapshot const& snapshot)
+{
+	Snapshot::Window const& window = snapshot.window;
+
+	for (int row = 0; row < window.rows; ++row) {
+		for (int col = 0; col < window.cols; ++col) {
+			int const i = row * window.cols + col;
+
+			if (m_Cached[i].region == nullptr &&
+					(!m_LODActive || m_LODTexels[IDX(window.col + col, window.row + row)] == 0))
+				Draw(snapshot.cells[i].jewel, &snapshot.camera);
+		}
+	}
+}
+
+// queues an object at its interpolated position, if it has a region
+void World::Draw(Engine::GameObject const& obj, Engine::Camera const* camera)
+{
+	Engine::TextureRegion const* region = obj.Region();
+
+	if (region == nullptr)
+		return;
+
+	Engine::GRect const rect = obj.Rect(m_Blend);
+
+	m_RQ.DrawSprite(camera != nullptr ? camera->ToScreen(rect) : rect,
+		*region, obj.Angle(), obj.Alpha());
+}
+
+// compares jewels to the cache contents, collecting dirty rectangles
+void World::CollectDirty(Snapshot const& snapshot)
+{
+	m_Animating = false;
+
+	if (!m_CacheValid) {
+		m_DirtyRects.clear();
+		AddDirty(Engine::GRect{ 0, 0, m_Background->Width(), m_Background->Height() });
+		for (auto& cached : m_Cached)
+			cached.region = nullptr;
+		m_CacheValid = true;
+	}
+
+	for (std::vector<Snapshot::Cell>::size_type i = 0; i < snapshot.cells.size(); ++i) {
+		Engine::GameObject const& j = snapshot.cells[i].jewel;
+		CachedJewel& cached = m_Cached[i];
+		bool const settled = snapshot.cells[i].settled;
+		// level of detail draws settled jewels itself
+		Engine::TextureRegion const* region = settled && !m_LODActive ? j.Region() : nullptr;
+		Engine::GRect const rect = snapshot.camera.ToScreen(j.Rect());
+
+		if (!settled && j.Region() != nullptr)
+			m_Animating = true;
+
+		if (region == cached.region && (region == nullptr ||
+				(rect.x == cached.rect.x && rect.y == cached.rect.y &&
+				 rect.w == cached.rect.w && rect.h == cached.rect.h)))
+			continue;
+
+		if (cached.region != nullptr)
+			AddDirty(cached.rect);
+		if (region != nullptr)
+			AddDirty(rect);
+
+		cached.region = region;
+		cached.rect = rect;
+	}
+}
+
+// adds a rectangle to redraw into the cache
+void World::AddDirty(Engine::GRect const& rect)
+{
+	// past this many rectangles it is cheaper to redraw their union
+	static constexpr std::vector<Engine::GRect>::size_type maxRects = 32;
+
+	if (m_DirtyRects.size() < maxRects) {
+		m_DirtyRects.push_back(rect);
+	} else {
+		SDL_UnionRect(&m_DirtyRects.back(), &rect, &m_DirtyRects.back());
+	}
+}
+
+// redraws the dirty rectangles of the cache
+void World::RedrawCache(Snapshot const& snapshot)
+{
+	Snapshot::Window const& window = snapshot.window;
+	Engine::GRect const background { 0, 0, m_Background->Width(), m_Background->Height() };
+
+	if (m_DirtyRects.empty())
+		return;
+
+	for (auto const& dirty : m_DirtyRects) {
+		Engine::GRect board;
+
+		m_CacheRQ.Layer(BackgroundLayer, &dirty);
+		m_CacheRQ.DrawSprite(background, *m_Background);
+
+		if (SDL_IntersectRect(&dirty, &m_VisibleArea, &board) != SDL_TRUE)
+			continue;
+
+		// settled jewels sit on their cells, but may be scaled over neighbours
+		int col1, row1, col2, row2;
+		S2M(snapshot.camera, board.x, board.y, col1, row1);
+		S2M(snapshot.camera, board.x + board.w - 1, board.y + board.h - 1, col2, row2);
+		col1 = std::max(col1 - 1, window.col);
+		row1 = std::max(row1 - 1, window.row);
+		col2 = std::min(col2 + 1, window.col + window.cols - 1);
+		row2 = std::min(row2 + 1, window.row + window.rows - 1);
+
+		m_CacheRQ.Layer(BoardLayer, &board);
+		for (int row = row1; row <= row2; ++row) {
+			for (int col = col1; col <= col2; ++col) {
+				CachedJewel const& cached = m_Cached[(row - window.row) * window.cols + col - window.col];
+				if (cached.region != nullptr)
+					m_CacheRQ.DrawSprite(cached.rect, *cached.region);
+			}
+		}
+	}
+
+	mp_G->SetRenderTarget(mp_Cache);
+	m_CacheRQ.Flush();
+	mp_G->SetRenderTarget(nullptr);
+
+	m_DirtyRects.clear();
+}
+
+// uploads texels of cells that changed, returns false if none did
+bool World::UpdateLOD(Snapshot const& snapshot)
 {
-	std::for_each(&jewels[0], &jewels[m_NumCols * m_NumRows],
-		[this](std::shared_ptr<Jewel>& j) {
-			Engine::TextureRegion const* region = j->Region();
-			if (region != nullptr)
-				m_SB.DrawSprite(*j, *region);
-		});
+	Snapshot::Window const& window = snapshot.window;
+	bool changed = false;
+
+	for (int row = window.row; row < window.row + window.rows; ++row) {
+		int left = m_NumCols, right = -1;
+
+		for (int col = window.col; col < window.col + window.cols; ++col) {
+			Snapshot::Cell const& cell = snapshot.cells[(row - window.row) * window.cols + col - window.col];
+			Engine::GRect const rect = cell.jewel.Rect();
+			// selected jewels are scaled up, so they stay sprites
+			Uint32 const texel = m_LODCells.Contains(col, row) && cell.settled &&
+				rect.w == m_ShrinkedJewelWidth && rect.h == m_ShrinkedJewelHeight ?
+				LODColor(cell.jewel.Region()) : 0;
+			Uint32& current = m_LODTexels[IDX(col, row)];
+
+			if (texel != current || !m_LODValid) {
+				current = texel;
+				left = std::min(left, col);
+				right = col;
+			}
+		}
+
+		// only the span of each row that changed goes up
+		if (right >= left) {
+			Engine::GRect const span { left, row, right - left + 1, 1 };
+			mp_LOD->Update(&span, &m_LODTexels[IDX(left, row)], m_NumCols * sizeof(Uint32));
+			changed = true;
+		}
+	}
+
+	m_LODValid = true;
+
+	return changed;
+}
+
+// texel standing for a settled jewel, RGBA8888
+Uint32 World::LODColor(Engine::TextureRegion const* region)
+{
+	Assets const& assets = Assets::Instance();
+
+	// roughly the average color of each jewel
+	if (region == assets.jewelYellow)
+		return 0xf0c818ff;
+	if (region == assets.jewelRed)
+		return 0xe02830ff;
+	if (region == assets.jewelPurple)
+		return 0xc040d0ff;
+	if (region == assets.jewelGreen)
+		return 0x30c040ff;
+	if (region == assets.jewelBlue)
+		return 0x3070e8ff;
+
+	return 0;
 }
 
 // renders the game's score and remaining time
-void World::DrawText()
+void World::DrawText(Snapshot const& snapshot)
 {
-	m_Font->Scale(1.0);
-	m_Font->Cursor(40, 150);
-	m_Font->DrawText(m_SB, "Score: ");
-	m_Font->DrawText(m_SB, std::to_string(m_Score));
-	m_Font->Scale(2.0);
-	m_Font->Cursor(93, 444);
-	m_Font->DrawText(m_SB, std::to_string(static_cast<int>(m_TimeRemaining)));
+	m_ScoreText.Number(snapshot.score);
+	m_TimeText.Number(snapshot.seconds);
+
+	m_ScoreLabel.Draw(m_RQ);
+	m_ScoreText.Draw(m_RQ);
+	m_TimeText.Draw(m_RQ);
 }
 
 // helper to perform both an array and a graphical swap of jewels
 void World::SwapHelper(int col1, int row1, int col2, int row2, double vel, double accel)
 {
 	int index1 = IDX(col1, row1), index2 = IDX(col2, row2);
-	std::shared_ptr<Jewel> tmp(jewels[index1]);
 
-	jewels[index1] = jewels[index2];
-	jewels[index2] = tmp;
-	jewels[index1]->MoveTo(M2S(col1, row1), vel, accel);
-	jewels[index2]->MoveTo(M2S(col2, row2), vel, accel);
+	m_Jewels.Swap(index1, index2);
+	m_Jewels.MoveTo(index1, M2S(col1, row1), vel, accel);
+	m_Jewels.MoveTo(index2, M2S(col2, row2), vel, accel);
+
+	// nobody would see them moving
+	if (!m_Window.Contains(col1, row1))
+		m_Jewels.Finish(index1);
+	if (!m_Window.Contains(col2, row2))
+		m_Jewels.Finish(index2);
 }
 
 World::World(Engine::Graphics *graphics, Engine::GRect const& area,
 				double time, int numcols, int numrows) :
-		mp_G{graphics}, m_SB(graphics),
-		m_Background{Assets::Instance().background},
-		m_Atlas{Assets::Instance().atlas},
+		mp_G{graphics}, m_RQ(graphics),
+		m_Background{Assets::Instance().backgroundRegion},
 		m_Font{Assets::Instance().font},
+		m_ScoreLabel{*m_Font}, m_ScoreText{*m_Font},
+		m_TimeText{*m_Font, 2.0}, m_GameOverText{*m_Font, 3.0},
+		m_Camera{}, m_Window{0, 0, 0, 0}, m_DrawnCamera{}, m_DrawnWindow{0, 0, 0, 0},
+		mp_Cache{nullptr}, m_CacheRQ(graphics), m_CacheValid{false},
+		m_Cached{}, m_DirtyRects{}, m_Animating{false},
+		mp_LOD{nullptr}, m_LODRegion{}, m_LODTexels{}, m_LODValid{false},
+		m_LODBelow{0}, m_LODActive{false}, m_LODCells{0, 0, 0, 0},
+		m_FrameDrawn{false}, m_LastScore{0}, m_LastSeconds{0},
+		m_LastGameOver{false}, m_LastReady{false}, m_Blend{1.0},
 		m_Matrix{std::make_shared<Miner::Matrix<Miner::Jewel>>(numcols, numrows)},
-		jewels{new std::shared_ptr<Jewel>[numcols * numrows]},
+		m_Stars{}, m_Jewels{numcols * numrows, &m_Stars},
 		m_Spark{time}, m_Rotation{1},
-		m_NumCols{numcols}, m_NumRows{numrows},
+		m_NumCols{numcols}, m_NumRows{numrows}, m_Gravity{0},
 		m_Score{0}, m_Time{time}, m_TimeRemaining{time},
 		m_GameOver{true},
 		m_Game{m_Matrix, this}
 {
 	m_VisibleArea = area;
 
+	m_ScoreLabel.Position(40, 150);
+	m_ScoreLabel.Text("Score: ");
+	m_ScoreText.Position(m_ScoreLabel.Cursor());
+	m_TimeText.Position(93, 444);
+	m_GameOverText.Position(175, 240);
+	m_GameOverText.Text("Game Over");
+
 	// select no jewel
 	m_SelectedCol = -1;
 	m_SelectedRow = -1;
 
-	m_JewelWidth = m_VisibleArea.w / m_NumCols;
-	m_JewelHeight = m_VisibleArea.h / m_NumRows;
-	m_MatrixWidthStart = m_VisibleArea.x + m_JewelWidth / 2;
-	m_MatrixHeightStart = m_VisibleArea.y + m_JewelHeight / 2;
+	/* cells keep the shape they have when the board fits the visible area,
+	 * but are a whole number of times bigger, so that zooming in all the
+	 * way shows jewels at about their size in the atlas
+	 */
+	int const fitwidth = std::max(m_VisibleArea.w / m_NumCols, 1);
+	int const fitheight = std::max(m_VisibleArea.h / m_NumRows, 1);
+	int const fitside = std::min(fitwidth, fitheight);
+	int const times = (fullCellSide + fitside - 1) / fitside;
+
+	m_JewelWidth = fitwidth * times;
+	m_JewelHeight = fitheight * times;
+	m_MatrixWidthStart = m_JewelWidth / 2;
+	m_MatrixHeightStart = m_JewelHeight / 2;
+
+	// falls take as long as they did with cells of the fitting size
+	m_Gravity = 9.81 * 100 * times;
+
+	m_Camera = Engine::Camera(m_VisibleArea, m_NumCols * m_JewelWidth, m_NumRows * m_JewelHeight);
+	m_Window = InView(m_Camera);
 
 	// shrink 5% to allow for a bit more space between them
 	m_ShrinkedJewelWidth = m_JewelWidth - m_JewelWidth / 20;
 	m_ShrinkedJewelHeight = m_JewelHeight - m_JewelHeight / 20;
 
+	// spinning jewels and stars, the static cache never has rotated ones
+	m_RQ.SetRotationCache(Assets::Instance().rotations);
+	// jewels can be drawn much smaller than they are in the atlas
+	m_RQ.SetScaleCache(Assets::Instance().scales);
+	m_CacheRQ.SetScaleCache(Assets::Instance().scales);
+
+	// without render targets everything is drawn every frame
+	if (mp_G->RenderTargetSupported()) {
+		mp_Cache = new Engine::Texture(m_Background->Width(), m_Background->Height(), mp_G->GetRenderer());
+		// the background is opaque, so no need to blend the cache
+		SDL_SetTextureBlendMode(mp_Cache->Tex(), SDL_BLENDMODE_NONE);
+	}
+
 	AcquireMatrix();
 }
 
+// draws settled jewels as texels when cells are smaller than below pixels
+bool World::UseLevelOfDetail(int below)
+{
+	// the blitter only draws textures it has the pixels of, and zooming
+	// out all the way has to get cells below the size
+	if (mp_LOD != nullptr || mp_G->UsingBlitter() ||
+			std::min(m_JewelWidth, m_JewelHeight) * m_Camera.MinScale() >= below)
+		return mp_LOD != nullptr;
+
+	m_LODBelow = below;
+	mp_LOD = new Engine::Texture(m_NumCols, m_NumRows, mp_G->GetRenderer(),
+			SDL_TEXTUREACCESS_STREAMING);
+	SDL_SetTextureBlendMode(mp_LOD->Tex(), SDL_BLENDMODE_BLEND);
+	m_LODRegion.Init(mp_LOD, 0, 0, m_NumCols, m_NumRows);
+	m_LODTexels.assign(m_NumCols * m_NumRows, 0);
+	m_LODValid = false;
+	// settled jewels in the cache have to go
+	m_CacheValid = false;
+
+	return true;
+}
+
 // resets all of the game data to start a new game
 void World::ResetGame()
 {
@@ -144,11 +432,13 @@ void World::ClickJewel(int x, int y)
 {
 	int col, row;
 
-	S2M(x, y, col, row);
-	// test for a click out of bounds, deselect any jewel selected
-	if (col < 0 || col >= m_NumCols || row < 0 || row >= m_NumRows) {
+	S2M(m_Camera, x, y, col, row);
+	// test for a click out of view or bounds, deselect any jewel selected
+	if (x < m_VisibleArea.x || x >= m_VisibleArea.x + m_VisibleArea.w ||
+			y < m_VisibleArea.y || y >= m_VisibleArea.y + m_VisibleArea.h ||
+			col < 0 || col >= m_NumCols || row < 0 || row >= m_NumRows) {
 		if (m_SelectedCol >= 0) {
-			jewels[IDX(m_SelectedCol, m_SelectedRow)]->Deselect();
+			m_Jewels.Deselect(IDX(m_SelectedCol, m_SelectedRow));
 			m_SelectedCol = -1;
 			m_SelectedRow = -1;
 		}
@@ -160,25 +450,44 @@ void World::ClickJewel(int x, int y)
 	if (m_SelectedCol < 0) {
 		m_SelectedCol = col;
 		m_SelectedRow = row;
-		jewels[index]->Select();
+		m_Jewels.Select(index);
 	} else {
 		// try to swap if possible... or deselect
 		if (m_Game.CanSwap(m_SelectedCol, m_SelectedRow, col, row)) {
-			jewels[index]->Select();
+			m_Jewels.Select(index);
 			m_Game.Swap(m_SelectedCol, m_SelectedRow, col, row);
 		} else {
-			jewels[IDX(m_SelectedCol, m_SelectedRow)]->Deselect();
+			m_Jewels.Deselect(IDX(m_SelectedCol, m_SelectedRow));
 		}
 		m_SelectedCol = -1;
 		m_SelectedRow = -1;
 	}
 }
 
+// zooms in, or out for negative steps, around screen point x, y
+void World::Zoom(int x, int y, int steps)
+{
+	// zoom around the center when not pointing at the board
+	if (x < m_VisibleArea.x || x >= m_VisibleArea.x + m_VisibleArea.w ||
+			y < m_VisibleArea.y || y >= m_VisibleArea.y + m_VisibleArea.h) {
+		x = m_VisibleArea.x + m_VisibleArea.w / 2;
+		y = m_VisibleArea.y + m_VisibleArea.h / 2;
+	}
+
+	m_Camera.Zoom(std::pow(zoomStep, steps), x, y);
+	CameraMoved();
+}
+
+// moves the camera by dx, dy screen pixels
+void World::Pan(int dx, int dy)
+{
+	m_Camera.Pan(dx, dy);
+	CameraMoved();
+}
+
 // update the world!
 void World::Update(double deltatime)
 {
-	bool animfinished = true;
-
 	// don't keep updating the spark and timer when game over
 	if (not m_GameOver) {
 		m_Spark.Update(deltatime);
@@ -190,66 +499,176 @@ void World::Update(double deltatime)
 		}
 	}
 
-	// update jewels game objects, check if any is still moving/animating
-	std::for_each(&jewels[0], &jewels[m_NumCols * m_NumRows],
-		[&deltatime, &animfinished](std::shared_ptr<Jewel>& j) {
-			j->Update(deltatime);
-			if (not j->Stopped())
-				animfinished = false;
-		});
+	// update the jewels still moving/animating; those out of the window
+	// are never left animating
+	m_Jewels.Update(deltatime);
 
 	// Don't advance the game's state until all animations have been
 	// performed. This is used as a simple synchronization mechanism
-	if (animfinished && !m_Game.Ready()) {
+	if (m_Jewels.Animating() == 0 && !m_Game.Ready()) {
 		m_Game.Go();
 	}
 
-	// destroy stars that are of no more use
-	m_StarList.remove_if([](Star const& s) { return s.Done(); });
+	m_Stars.Update(deltatime);
+}
+
+// copies what is needed to draw the current state
+void World::Publish(Snapshot& snapshot)
+{
+	snapshot.camera = m_Camera;
+	snapshot.window = m_Window;
+	snapshot.cells.resize(m_Window.cols * m_Window.rows);
+	for (int row = 0; row < m_Window.rows; ++row) {
+		for (int col = 0; col < m_Window.cols; ++col) {
+			int const index = IDX(m_Window.col + col, m_Window.row + row);
+			Snapshot::Cell& cell = snapshot.cells[row * m_Window.cols + col];
+
+			m_Jewels.Get(index, cell.jewel);
+			// only settled and unrotated jewels can be cached
+			cell.settled = m_Jewels.Settled(index);
+		}
+	}
+
+	snapshot.stars = m_Stars;
+	snapshot.spark = m_Spark;
 
-	for (auto& star : m_StarList)
-		star.Update(deltatime);
+	snapshot.score = m_Score;
+	snapshot.seconds = static_cast<int>(m_TimeRemaining);
+	snapshot.gameOver = m_GameOver;
+	snapshot.ready = m_Game.Ready();
+	snapshot.animating = NextChange() == 0;
 }
 
-// draw a frame
-void World::Render(double deltatime)
+// draw a snapshot, returns false if skipped because nothing changed
+bool World::Render(Snapshot const& snapshot, double blend)
 {
-	// clear and draw the background
+	// nothing published yet
+	if (snapshot.cells.empty())
+		return false;
+
+	m_Blend = blend;
+
+	// everything moves on screen along with the camera
+	if (snapshot.window != m_DrawnWindow) {
+		m_Cached.assign(snapshot.cells.size(), CachedJewel{ nullptr, Engine::GRect{} });
+		m_CacheValid = false;
+		m_LODValid = false;
+	} else if (snapshot.camera != m_DrawnCamera) {
+		m_CacheValid = false;
+	}
+	m_DrawnCamera = snapshot.camera;
+	m_DrawnWindow = snapshot.window;
+
+	// texels are only worth it while cells are tiny on screen
+	bool const lod = mp_LOD != nullptr &&
+		std::min(m_JewelWidth, m_JewelHeight) * snapshot.camera.Scale() < m_LODBelow;
+	if (lod != m_LODActive) {
+		m_LODActive = lod;
+		m_CacheValid = false;
+		m_LODValid = false;
+	}
+	if (m_LODActive)
+		m_LODCells = InFullView(snapshot.camera);
+
+	if (mp_Cache != nullptr)
+		CollectDirty(snapshot);
+	else
+		m_Animating = true;
+
+	bool const lodchanged = m_LODActive && UpdateLOD(snapshot);
+
+	// the spark animates while playing, otherwise look for any change
+	if (m_FrameDrawn && snapshot.gameOver && !m_Animating && m_DirtyRects.empty() && !lodchanged &&
+			snapshot.stars.Empty() && snapshot.score == m_LastScore &&
+			snapshot.seconds == m_LastSeconds && snapshot.gameOver == m_LastGameOver &&
+			snapshot.ready == m_LastReady)
+		return false;
+
 	mp_G->Clear();
-	mp_G->RenderCopy(m_Background, nullptr, nullptr);
+
+	if (mp_Cache != nullptr) {
+		RedrawCache(snapshot);
+		mp_G->RenderCopy(mp_Cache, nullptr, nullptr);
+	} else {
+		Engine::GRect background { 0, 0, m_Background->Width(), m_Background->Height() };
+
+		m_RQ.Layer(BackgroundLayer);
+		m_RQ.DrawSprite(background, *m_Background);
+	}
+
+	if (m_LODActive) {
+		Snapshot::Window const& window = m_LODCells;
+		Engine::GRect const cells { window.col * m_JewelWidth, window.row * m_JewelHeight,
+			window.cols * m_JewelWidth, window.rows * m_JewelHeight };
+
+		m_LODRegion.Init(mp_LOD, window.col, window.row, window.cols, window.rows);
+		m_RQ.Layer(DetailLayer, &m_VisibleArea);
+		m_RQ.DrawSprite(snapshot.camera.ToScreen(cells), m_LODRegion);
+	}
 
 	/* the matrix render is performed within a clipping
 	 * area that allows us to let jewels "drop in" from
-	 * the ceiling, this is why we end this batch so
-	 * prematurely (as compared to adding other objects
-	 * living within the same atlas)
-	 * Note: this is due to current engine backend API
-	 * limitations (ie. SDL2 2D API)
+	 * the ceiling
 	 */
-	m_SB.BeginBatch(m_Atlas, &m_VisibleArea);
-	DrawMatrix();
-	m_SB.EndBatch();
+	m_RQ.Layer(BoardLayer, &m_VisibleArea);
+	DrawMatrix(snapshot);
 
 	// draw the rest of the game elements
-	m_SB.BeginBatch(m_Atlas);
+	m_RQ.Layer(FrontLayer);
 
-	DrawText();
-	if (m_GameOver) {
-		if (m_Game.Ready()) {
-			m_Font->Scale(3.0);
-			m_Font->Cursor(175, 240);
-			m_Font->DrawText(m_SB, "Game Over");
-		}
+	DrawText(snapshot);
+	if (snapshot.gameOver) {
+		if (snapshot.ready)
+			m_GameOverText.Draw(m_RQ);
 	} else {
-		m_SB.DrawSprite(m_Spark);
+		Draw(snapshot.spark);
 	}
-	for (auto& star : m_StarList)
-		m_SB.DrawSprite(star);
 
-	m_SB.EndBatch();
+	// stars fly off the board, unless there is more of it around
+	if (snapshot.camera.Scale() > snapshot.camera.MinScale())
+		m_RQ.Layer(FrontLayer, &m_VisibleArea);
+	Engine::TextureRegion const& star = *Assets::Instance().star;
+	for (std::size_t i = 0; i < snapshot.stars.Size(); ++i)
+		m_RQ.DrawSprite(snapshot.camera.ToScreen(snapshot.stars.Rect(i, m_Blend)), star,
+			snapshot.stars.Angle(i), snapshot.stars.Alpha(i));
+
+	m_RQ.Flush();
 
 	// throw it all to the screen
 	mp_G->Present();
+
+	m_FrameDrawn = true;
+	m_LastScore = snapshot.score;
+	m_LastSeconds = snapshot.seconds;
+	m_LastGameOver = snapshot.gameOver;
+	m_LastReady = snapshot.ready;
+
+	return true;
+}
+
+// seconds until something on screen is due to change on its own
+double World::NextChange()
+{
+	if (!m_Stars.Empty() || !m_Game.Ready())
+		return 0;
+
+	// jewels that just stopped still need a step to settle where drawn
+	if (!m_Jewels.Idle())
+		return 0;
+
+	if (m_GameOver)
+		return -1;
+
+	// the countdown shows whole seconds, and the spark has its own pace
+	double next = m_TimeRemaining - std::floor(m_TimeRemaining);
+	if (next == 0)
+		next = 1;
+
+	double const spark = m_Spark.NextChange();
+	if (spark >= 0 && spark < next)
+		next = spark;
+
+	return next;
 }
 
 // Miner::Listener interface implementation
@@ -259,14 +678,14 @@ void World::Swapped(int col1, int row1, int col2, int row2) {
 
 void World::SwapOK(int col1, int row1, int col2, int row2) {
 	// swap will match, deselect both jewels
-	jewels[IDX(col1, row1)]->Deselect();
-	jewels[IDX(col2, row2)]->Deselect();
+	m_Jewels.Deselect(IDX(col1, row1));
+	m_Jewels.Deselect(IDX(col2, row2));
 }
 
 void World::SwapFailed(int col1, int row1, int col2, int row2) {
 	// swapfailed, deselect jewels and swap them back
-	jewels[IDX(col1, row1)]->Deselect();
-	jewels[IDX(col2, row2)]->Deselect();
+	m_Jewels.Deselect(IDX(col1, row1));
+	m_Jewels.Deselect(IDX(col2, row2));
 	SwapHelper(col1, row1, col2, row2, (col1 == col2) ? m_JewelHeight * 4 : m_JewelWidth * 4, 0);
 }
 
@@ -277,10 +696,7 @@ void World::Ready() {
 void World::Deletion(Miner::Event<Miner::Jewel>::Target target, int num,
 		int start, Miner::Event<Miner::Jewel>::container_type& container) {}
 void World::Insertion(Miner::Event<Miner::Jewel>::Target target, int num,
-		int start, Miner::Event<Miner::Jewel>::container_type& container)
-{
-	m_Score += container.size() * 10;
-}
+		int start, Miner::Event<Miner::Jewel>::container_type& container) {}
 
 void World::CycleFinished()
 {
@@ -291,7 +707,7 @@ void World::CycleFinished()
 void World::Fall(int column, int row, int gaps)
 {
 	// apply gravity to a jewel down to a new place
-	SwapHelper(column, row, column, row + gaps, 0, 9.81 * 100);
+	SwapHelper(column, row, column, row + gaps, 0, m_Gravity);
 }
 
 // creates a new jewel ready to fall from the ceiling
@@ -299,9 +715,11 @@ void World::New(int column, int row, Miner::Jewel::Color color, int totalgaps)
 {
 	int index = IDX(column, row);
 
-	jewels[index]->SetColor(color);
-	jewels[index]->SetPosition(M2S(column, row - totalgaps));
-	jewels[index]->MoveTo(M2S(column, row), 0, 9.81 * 100);
+	m_Jewels.SetColor(index, color);
+	m_Jewels.SetPosition(index, M2S(column, row - totalgaps));
+	m_Jewels.MoveTo(index, M2S(column, row), 0, m_Gravity);
+	if (!m_Window.Contains(column, row))
+		m_Jewels.Finish(index);
 }
 
 // spin a jewel to explosion
@@ -314,7 +732,15 @@ void World::Delete(Miner::Event<Miner::Jewel>::Target target, int colrow, int po
 	else
 		index = IDX(pos, colrow);
 
-	jewels[index]->Explode(0.6, 0, 4080 * m_Rotation);
+	m_Jewels.Explode(index, 0.6, 0, 4080 * m_Rotation);
+	if (!m_Window.Contains(index % m_NumCols, index / m_NumCols))
+		m_Jewels.Finish(index);
 }
 
 void World::Destroyed(int matches) {}
+
+// score a group of matched jewels
+void World::Matched(int column, int row, int size)
+{
+	m_Score += size * 10;
+}
@@ -8,6 +8,7 @@
 
 #include "engine/Animation.h"
 
+#include <cmath>
 #include <vector>
 
 namespace Engine {
@@ -36,4 +37,16 @@ TextureRegion const* Animation::KeyFrame(double statetime) const
 	return m_KeyFrames[framenumber];
 }
 
+// seconds from statetime until the keyframe changes, negative if never
+double Animation::NextKeyFrame(double statetime) const
+{
+	double const framenumber = std::floor(statetime / m_FrameDuration);
+
+	if (m_KeyFrames.size() < 2 ||
+			(m_Mode == Mode::NonLooping && framenumber >= m_KeyFrames.size() - 1))
+		return -1;
+
+	return (framenumber + 1) * m_FrameDuration - statetime;
+}
+
 }	// Engine
@@ -0,0 +1,345 @@
+/* Blitter.cpp - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * A CPU renderer for hosts without a GPU, used by Graphics instead of SDL's
+ * software renderer. Sprites are blended into a premultiplied ARGB frame in
+ * system memory, which is uploaded to a streaming texture once per frame.
+ */
+
+#include <SDL2/SDL.h>
+
+#include "util/Math.h"
+
+#include "engine/Graphics.h"
+#include "engine/Texture.h"
+
+#include "engine/Blitter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Engine {
+
+namespace {
+
+// x * y / 255, rounded, for x and y in 0..255
+inline Uint32 mul255(Uint32 x, Uint32 y)
+{
+	Uint32 t = x * y + 128;
+	return (t + (t >> 8)) >> 8;
+}
+
+// premultiplied source over destination, with source scaled by alpha
+inline Uint32 blend(Uint32 d, Uint32 s, Uint32 alpha)
+{
+	if (alpha != 255) {
+		s = mul255(s >> 24, alpha) << 24 | mul255((s >> 16) & 0xff, alpha) << 16 |
+			mul255((s >> 8) & 0xff, alpha) << 8 | mul255(s & 0xff, alpha);
+	}
+
+	Uint32 const inv = 255 - (s >> 24);
+
+	return s + (mul255(d >> 24, inv) << 24 | mul255((d >> 16) & 0xff, inv) << 16 |
+		mul255((d >> 8) & 0xff, inv) << 8 | mul255(d & 0xff, inv));
+}
+
+#if defined(__AVX2__)
+// x * y / 255 on 16 bit lanes
+inline __m256i mul255(__m256i x, __m256i y)
+{
+	__m256i t = _mm256_add_epi16(_mm256_mullo_epi16(x, y), _mm256_set1_epi16(128));
+	return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+// blends two pixels per 64 bits of unpacked s and d
+inline __m256i blend(__m256i d, __m256i s, __m256i alpha)
+{
+	s = mul255(s, alpha);
+	__m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0xff), 0xff);
+	__m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+	return _mm256_add_epi16(s, mul255(d, inv));
+}
+#elif defined(__SSE2__)
+// x * y / 255 on 16 bit lanes
+inline __m128i mul255(__m128i x, __m128i y)
+{
+	__m128i t = _mm_add_epi16(_mm_mullo_epi16(x, y), _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+// blends two pixels per 64 bits of unpacked s and d
+inline __m128i blend(__m128i d, __m128i s, __m128i alpha)
+{
+	s = mul255(s, alpha);
+	__m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xff), 0xff);
+	__m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), a);
+	return _mm_add_epi16(s, mul255(d, inv));
+}
+#endif
+
+// blends n premultiplied pixels from src over dst
+void blendspan(Uint32 *dst, Uint32 const* src, int n, Uint32 alpha)
+{
+	int i = 0;
+
+#if defined(__AVX2__)
+	__m256i const zero = _mm256_setzero_si256();
+	__m256i const a = _mm256_set1_epi16(alpha);
+
+	for (; i + 8 <= n; i += 8) {
+		__m256i s = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+		__m256i d = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(dst + i));
+		__m256i lo = blend(_mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi8(s, zero), a);
+		__m256i hi = blend(_mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi8(s, zero), a);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+	}
+#elif defined(__SSE2__)
+	__m128i const zero = _mm_setzero_si128();
+	__m128i const a = _mm_set1_epi16(alpha);
+
+	for (; i + 4 <= n; i += 4) {
+		__m128i s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+		__m128i d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dst + i));
+		__m128i lo = blend(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(s, zero), a);
+		__m128i hi = blend(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(s, zero), a);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+	}
+#endif
+
+	for (; i < n; ++i)
+		dst[i] = blend(dst[i], src[i], alpha);
+}
+
+// a + (b - a) * w / 256 on all four channels at once
+inline Uint32 lerp(Uint32 a, Uint32 b, Uint32 w)
+{
+	Uint32 const rb = (((a & 0xff00ff) * (256 - w) + (b & 0xff00ff) * w) >> 8) & 0xff00ff;
+	Uint32 const ag = (((a >> 8) & 0xff00ff) * (256 - w) + ((b >> 8) & 0xff00ff) * w) & 0xff00ff00;
+	return rb | ag;
+}
+
+// bilinear sample at 16.16 fixed point coordinates, clamped to src
+inline Uint32 bilinear(Uint32 const* pixels, int pitch, GRect const& src, int fx, int fy)
+{
+	fx = std::min(std::max(fx, 0), (src.w - 1) << 16);
+	fy = std::min(std::max(fy, 0), (src.h - 1) << 16);
+
+	int const x0 = fx >> 16, y0 = fy >> 16;
+	int const x1 = std::min(x0 + 1, src.w - 1), y1 = std::min(y0 + 1, src.h - 1);
+	Uint32 const wx = (fx >> 8) & 0xff, wy = (fy >> 8) & 0xff;
+	Uint32 const* row0 = pixels + (src.y + y0) * pitch + src.x;
+	Uint32 const* row1 = pixels + (src.y + y1) * pitch + src.x;
+
+	return lerp(lerp(row0[x0], row0[x1], wx), lerp(row1[x0], row1[x1], wx), wy);
+}
+
+}	// anonymous
+
+Blitter::Blitter(SDL_Renderer *renderer, int width, int height, Filter filter) noexcept(false) :
+		mp_Renderer{renderer}, mp_Stream{nullptr}, m_Width{width}, m_Height{height},
+		m_Filter{filter}, m_Clip{0, 0, width, height},
+		m_Frame(width * height), m_Span(width)
+{
+	mp_Stream = SDL_CreateTexture(mp_Renderer, SDL_PIXELFORMAT_ARGB8888,
+			SDL_TEXTUREACCESS_STREAMING, m_Width, m_Height);
+
+	if (mp_Stream == nullptr)
+		throw std::runtime_error(SDL_GetError());
+
+	// the frame is opaque, blending it again would only cost time
+	SDL_SetTextureBlendMode(mp_Stream, SDL_BLENDMODE_NONE);
+}
+
+Blitter::~Blitter()
+{
+	if (mp_Stream != nullptr)
+		SDL_DestroyTexture(mp_Stream);
+}
+
+void Blitter::Clear()
+{
+	std::fill(m_Frame.begin(), m_Frame.end(), 0xff000000);
+}
+
+void Blitter::SetClip(GRect const* clip)
+{
+	GRect const frame { 0, 0, m_Width, m_Height };
+
+	if (clip == nullptr || SDL_IntersectRect(clip, &frame, &m_Clip) != SDL_TRUE) {
+		m_Clip = frame;
+		// empty intersections clip everything away
+		if (clip != nullptr)
+			m_Clip.w = m_Clip.h = 0;
+	}
+}
+
+Blitter::Image Blitter::Pixels(Texture *texture) noexcept(false)
+{
+	SDL_Surface *surface = texture->Surface();
+	if (surface == nullptr)
+		throw std::runtime_error("Blitter: texture has no pixels in system memory");
+
+	std::vector<Uint32>& pixels = texture->Premultiplied();
+	Image const image { nullptr, surface->w, surface->h };
+
+	if (!pixels.empty())
+		return Image{ pixels.data(), image.width, image.height };
+
+	// surfaces come in RGBA8888, turn them into premultiplied ARGB8888
+	pixels.resize(image.width * image.height);
+
+	SDL_LockSurface(surface);
+	for (int y = 0; y < image.height; ++y) {
+		Uint32 const* row = reinterpret_cast<Uint32 const*>(
+			static_cast<Uint8 const*>(surface->pixels) + y * surface->pitch);
+		for (int x = 0; x < image.width; ++x) {
+			Uint32 const p = row[x];
+			Uint32 const a = p & 0xff;
+			pixels[y * image.width + x] = a << 24 | mul255(p >> 24, a) << 16 |
+				mul255((p >> 16) & 0xff, a) << 8 | mul255((p >> 8) & 0xff, a);
+		}
+	}
+	SDL_UnlockSurface(surface);
+
+	return Image{ pixels.data(), image.width, image.height };
+}
+
+void Blitter::Draw(Texture *texture, GRect const& src, GRect const& dst,
+		double angle, GPoint const* center) noexcept(false)
+{
+	Image const image = Pixels(texture);
+	unsigned int const alpha = std::lround(texture->Alpha() * 255);
+	GRect box;
+
+	if (alpha == 0 || src.w <= 0 || src.h <= 0 || dst.w <= 0 || dst.h <= 0)
+		return;
+
+	if (std::fmod(angle, 360.0) == 0) {
+		if (SDL_IntersectRect(&dst, &m_Clip, &box) == SDL_TRUE)
+			DrawScaled(image, src, dst, box, alpha);
+		return;
+	}
+
+	double const cx = dst.x + (center != nullptr ? center->x : dst.w / 2.0);
+	double const cy = dst.y + (center != nullptr ? center->y : dst.h / 2.0);
+	double const rad = Util::to_radians(angle);
+	double const c = std::cos(rad), s = std::sin(rad);
+	double minx = cx, miny = cy, maxx = cx, maxy = cy;
+
+	// bounding box of the rotated corners
+	for (int i = 0; i < 4; ++i) {
+		double const x = (i & 1 ? dst.x + dst.w : dst.x) - cx;
+		double const y = (i & 2 ? dst.y + dst.h : dst.y) - cy;
+		double const rx = cx + x * c - y * s;
+		double const ry = cy + x * s + y * c;
+		minx = std::min(minx, rx);
+		maxx = std::max(maxx, rx);
+		miny = std::min(miny, ry);
+		maxy = std::max(maxy, ry);
+	}
+
+	GRect bounds;
+	bounds.x = std::floor(minx);
+	bounds.y = std::floor(miny);
+	bounds.w = static_cast<int>(std::ceil(maxx)) - bounds.x;
+	bounds.h = static_cast<int>(std::ceil(maxy)) - bounds.y;
+
+	if (SDL_IntersectRect(&bounds, &m_Clip, &box) == SDL_TRUE)
+		DrawRotated(image, src, dst, box, angle, cx, cy, alpha);
+}
+
+void Blitter::DrawScaled(Image const& image, GRect const& src, GRect const& dst,
+		GRect const& box, unsigned int alpha)
+{
+	Uint32 const* pixels = image.pixels;
+	int const pitch = image.width;
+	bool const unscaled = src.w == dst.w && src.h == dst.h;
+	bool const nearest = unscaled || m_Filter == Filter::Nearest;
+
+	// 16.16 fixed point source step per destination pixel
+	int const stepx = (static_cast<long long>(src.w) << 16) / dst.w;
+	int const stepy = (static_cast<long long>(src.h) << 16) / dst.h;
+
+	for (int y = box.y; y < box.y + box.h; ++y) {
+		Uint32 *out = &m_Frame[y * m_Width + box.x];
+		Uint32 const* in;
+
+		if (unscaled) {
+			// straight from the image, no need for a span
+			in = pixels + (src.y + y - dst.y) * pitch + src.x + box.x - dst.x;
+		} else if (nearest) {
+			// sample at pixel centers
+			int const sy = ((y - dst.y) * stepy + stepy / 2) >> 16;
+			Uint32 const* row = pixels + (src.y + sy) * pitch + src.x;
+			int fx = (box.x - dst.x) * stepx + stepx / 2;
+
+			for (int i = 0; i < box.w; ++i, fx += stepx)
+				m_Span[i] = row[fx >> 16];
+			in = m_Span.data();
+		} else {
+			int const fy = (y - dst.y) * stepy + stepy / 2 - 0x8000;
+			int fx = (box.x - dst.x) * stepx + stepx / 2 - 0x8000;
+
+			for (int i = 0; i < box.w; ++i, fx += stepx)
+				m_Span[i] = bilinear(pixels, pitch, src, fx, fy);
+			in = m_Span.data();
+		}
+
+		blendspan(out, in, box.w, alpha);
+	}
+}
+
+void Blitter::DrawRotated(Image const& image, GRect const& src, GRect const& dst,
+		GRect const& box, double angle, double cx, double cy, unsigned int alpha)
+{
+	Uint32 const* pixels = image.pixels;
+	int const pitch = image.width;
+	double const rad = Util::to_radians(angle);
+	double const c = std::cos(rad), s = std::sin(rad);
+	// destination to source scale, in 16.16 fixed point
+	double const scalex = 65536.0 * src.w / dst.w;
+	double const scaley = 65536.0 * src.h / dst.h;
+	int const limitx = src.w << 16, limity = src.h << 16;
+
+	for (int y = box.y; y < box.y + box.h; ++y) {
+		Uint32 *out = &m_Frame[y * m_Width + box.x];
+		double const dx = box.x + 0.5 - cx;
+		double const dy = y + 0.5 - cy;
+		// rotate back into the unrotated dst, then into source coordinates
+		double u = ((dx * c + dy * s) + cx - dst.x) * scalex;
+		double v = ((-dx * s + dy * c) + cy - dst.y) * scaley;
+		double const du = c * scalex, dv = -s * scaley;
+
+		for (int i = 0; i < box.w; ++i, u += du, v += dv) {
+			int const fx = static_cast<int>(std::floor(u));
+			int const fy = static_cast<int>(std::floor(v));
+
+			if (fx < 0 || fy < 0 || fx >= limitx || fy >= limity)
+				m_Span[i] = 0;
+			else if (m_Filter == Filter::Nearest)
+				m_Span[i] = pixels[(src.y + (fy >> 16)) * pitch + src.x + (fx >> 16)];
+			else
+				m_Span[i] = bilinear(pixels, pitch, src, fx - 0x8000, fy - 0x8000);
+		}
+
+		blendspan(out, m_Span.data(), box.w, alpha);
+	}
+}
+
+void Blitter::Upload() noexcept(false)
+{
+	if (SDL_UpdateTexture(mp_Stream, nullptr, m_Frame.data(), m_Width * sizeof(Uint32)) < 0)
+		throw std::runtime_error(SDL_GetError());
+
+	if (SDL_RenderCopy(mp_Renderer, mp_Stream, nullptr, nullptr) < 0)
+		throw std::runtime_error(SDL_GetError());
+}
+
+}	// Engine
@@ -0,0 +1,72 @@
+/* Camera.cpp - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * A Camera looks at part of a world bigger than the screen through a viewport,
+ * at any scale between fitting the whole world in the viewport and showing it
+ * at its full size.
+ */
+
+#include "engine/Vector2.h"
+#include "engine/Graphics.h"	// for GRect
+
+#include "engine/Camera.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Engine {
+
+Camera::Camera() : m_Viewport{}, m_WorldWidth{0}, m_WorldHeight{0},
+		m_X{0}, m_Y{0}, m_Scale{1.0}, m_MinScale{1.0} {}
+
+Camera::Camera(GRect const& viewport, double worldwidth, double worldheight) :
+		m_Viewport(viewport), m_WorldWidth{worldwidth}, m_WorldHeight{worldheight},
+		m_X{0}, m_Y{0}, m_Scale{1.0}, m_MinScale{1.0}
+{
+	// worlds smaller than the viewport are never blown up
+	m_MinScale = std::min(1.0, std::min(viewport.w / worldwidth, viewport.h / worldheight));
+	m_Scale = m_MinScale;
+}
+
+// scales by factor, keeping the world under screen point x, y in place
+void Camera::Zoom(double factor, int x, int y)
+{
+	Vector2<double> const anchor = ToWorld(x, y);
+
+	m_Scale = std::max(m_MinScale, std::min(m_Scale * factor, 1.0));
+	m_X = anchor.X() - (x - m_Viewport.x) / m_Scale;
+	m_Y = anchor.Y() - (y - m_Viewport.y) / m_Scale;
+	Clamp();
+}
+
+// moves the view by dx, dy screen pixels
+void Camera::Pan(int dx, int dy)
+{
+	m_X += dx / m_Scale;
+	m_Y += dy / m_Scale;
+	Clamp();
+}
+
+// rounds the edges rather than the size, so neighbours never leave gaps
+GRect Camera::ToScreen(GRect const& rect) const
+{
+	int const x1 = lround(m_Viewport.x + (rect.x - m_X) * m_Scale);
+	int const y1 = lround(m_Viewport.y + (rect.y - m_Y) * m_Scale);
+	int const x2 = lround(m_Viewport.x + (rect.x + rect.w - m_X) * m_Scale);
+	int const y2 = lround(m_Viewport.y + (rect.y + rect.h - m_Y) * m_Scale);
+
+	return GRect{ x1, y1, x2 - x1, y2 - y1 };
+}
+
+Vector2<double> Camera::ToWorld(int x, int y) const
+{
+	return Vector2<double>(m_X + (x - m_Viewport.x) / m_Scale, m_Y + (y - m_Viewport.y) / m_Scale);
+}
+
+// keeps the view within the world
+void Camera::Clamp()
+{
+	m_X = std::max(0.0, std::min(m_X, m_WorldWidth - ViewWidth()));
+	m_Y = std::max(0.0, std::min(m_Y, m_WorldHeight - ViewHeight()));
+}
+
+}	// Engine
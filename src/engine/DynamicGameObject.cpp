@@ -38,6 +38,7 @@ void DynamicGameObject::Update(double deltatime)
 }
 
 void DynamicGameObject::UpdatePosition(double deltatime) {
+	m_PrevPosition = m_Position;
 	m_Velocity += m_Accel * deltatime;
 	m_Position += m_Velocity * deltatime;
 	if (m_TargetMode) {
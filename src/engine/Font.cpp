@@ -10,7 +10,7 @@
 
 #include "engine/Texture.h"
 #include "engine/TextureRegion.h"
-#include "engine/SpriteBatcher.h"
+#include "engine/SpriteTarget.h"
 
 #include "util/Math.h"
 
@@ -56,6 +56,13 @@ void Font::Scale(double const scale, bool kerningreset)
 	m_Scale = scale;
 }
 
+TextureRegion const* Font::Glyph(char c) const
+{
+	unsigned char ch = c - ' ';
+
+	return ch < NumGlyphs ? &m_Glyphs[ch] : nullptr;
+}
+
 Vector2<double> Font::GlyphBox(double angle)
 {
 	double rad = Util::to_radians(angle);
@@ -67,7 +74,7 @@ Vector2<double> Font::GlyphBox(double angle)
 				m_GlyphHeight * cos};
 }
 
-void Font::DrawText(SpriteBatcher& batcher, std::string const& text, int x, int y,
+void Font::DrawText(SpriteTarget& batcher, std::string const& text, int x, int y,
 				double angle, double glyphangle, GPoint const* center)
 {
 	Vector2<double> line;
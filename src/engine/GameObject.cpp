@@ -14,15 +14,15 @@
 
 namespace Engine {
 
-GameObject::GameObject() : m_Position{}, m_Width{0}, m_Height{0},
+GameObject::GameObject() : m_Position{}, m_PrevPosition{}, m_Width{0}, m_Height{0},
 		m_Angle{0}, m_Alpha{1.0}, mp_Region{} {}
 
 GameObject::GameObject(double x, double y, int width, int height, double angle) :
-		m_Position{x, y}, m_Width{width}, m_Height{height},
+		m_Position{x, y}, m_PrevPosition{x, y}, m_Width{width}, m_Height{height},
 		m_Angle{angle}, m_Alpha{1.0}, mp_Region{} {}
 
 GameObject::GameObject(Vector2<double> const& position, int width, int height, double angle) :
-		m_Position{position}, m_Width{width}, m_Height{height},
+		m_Position{position}, m_PrevPosition{position}, m_Width{width}, m_Height{height},
 		m_Angle{angle}, m_Alpha{1.0}, mp_Region{} {}
 
 GameObject::~GameObject() {}
@@ -50,14 +50,36 @@ GRect GameObject::Rect() const
 	return res;
 }
 
+// rectangle at blend (0 to 1) between the previous and current position
+GRect GameObject::Rect(double blend) const
+{
+	double const x = m_PrevPosition.X() + (m_Position.X() - m_PrevPosition.X()) * blend;
+	double const y = m_PrevPosition.Y() + (m_Position.Y() - m_PrevPosition.Y()) * blend;
+	GRect res;
+	res.x = lround(x - m_Width/2);
+	res.y = lround(y - m_Height/2);
+	res.w = m_Width;
+	res.h = m_Height;
+	return res;
+}
+
 void GameObject::SetPosition(Vector2<double> const& pos)
 {
 	m_Position = pos;
+	m_PrevPosition = pos;
 }
 
 void GameObject::SetPosition(double x, double y)
 {
 	m_Position.Set(x, y);
+	m_PrevPosition.Set(x, y);
+}
+
+// sets the position along with the one before the last update
+void GameObject::SetPosition(Vector2<double> const& pos, Vector2<double> const& prevpos)
+{
+	m_Position = pos;
+	m_PrevPosition = prevpos;
 }
 
 }	// Engine
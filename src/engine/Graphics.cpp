@@ -9,6 +9,7 @@
 #include <SDL2/SDL_image.h>
 
 #include "engine/Texture.h"
+#include "engine/Blitter.h"
 
 #include "engine/Graphics.h"
 
@@ -16,7 +17,8 @@
 
 namespace Engine {
 
-Graphics::Graphics() : mp_Window{nullptr}, mp_Renderer{nullptr}
+Graphics::Graphics() : mp_Window{nullptr}, mp_Renderer{nullptr}, mp_Blitter{nullptr},
+		mp_Offscreen{nullptr}, m_Viewport{}, m_FrameStart{0}, m_FrameTime{0}
 {
 	if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG))
 		throw std::runtime_error(IMG_GetError());
@@ -39,6 +41,10 @@ void Graphics::Window(std::string const& title, int width, int height, bool full
 	if (mp_Window == NULL)
 		throw std::runtime_error(SDL_GetError());
 
+	delete mp_Blitter;
+	mp_Blitter = nullptr;
+	delete mp_Offscreen;
+	mp_Offscreen = nullptr;
 	if (mp_Renderer != nullptr) {
 		SDL_DestroyRenderer(mp_Renderer);
 		mp_Renderer = nullptr;
@@ -63,6 +69,38 @@ void Graphics::SetLogicalSize(int width, int height)
 	SDL_RenderSetLogicalSize(mp_Renderer, width, height);
 }
 
+void Graphics::UseBlitter(bool bilinear) noexcept(false)
+{
+	delete mp_Blitter;
+	mp_Blitter = nullptr;
+	mp_Blitter = new Blitter(mp_Renderer, m_Viewport.w, m_Viewport.h,
+			bilinear ? Blitter::Filter::Bilinear : Blitter::Filter::Nearest);
+}
+
+bool Graphics::UseOffscreen() noexcept(false)
+{
+	// the Blitter already draws at the logical size
+	if (mp_Blitter != nullptr || mp_Offscreen != nullptr)
+		return true;
+	if (!RenderTargetSupported())
+		return false;
+
+	mp_Offscreen = new Texture(m_Viewport.w, m_Viewport.h, mp_Renderer);
+	// the frame is opaque, no need to blend it onto the window
+	SDL_SetTextureBlendMode(mp_Offscreen->Tex(), SDL_BLENDMODE_NONE);
+	SetRenderTarget(nullptr);
+
+	return true;
+}
+
+void Graphics::SetClipRect(GRect const* clip)
+{
+	if (mp_Blitter != nullptr)
+		mp_Blitter->SetClip(clip);
+	else
+		SDL_RenderSetClipRect(mp_Renderer, clip);
+}
+
 void Graphics::SetViewport(GRect const* viewport)
 {
 	SDL_RenderSetViewport(mp_Renderer, viewport);
@@ -80,27 +118,92 @@ void Graphics::SetViewport(int x, int y, int w, int h)
 
 void Graphics::Clear()
 {
-	SDL_RenderClear(mp_Renderer);
+	m_FrameStart = SDL_GetPerformanceCounter();
+	if (mp_Blitter != nullptr)
+		mp_Blitter->Clear();
+	else
+		SDL_RenderClear(mp_Renderer);
+}
+
+bool Graphics::RenderTargetSupported() const
+{
+	// the Blitter only ever draws to its own frame
+	return mp_Blitter == nullptr && SDL_RenderTargetSupported(mp_Renderer) == SDL_TRUE;
+}
+
+bool Graphics::SoftwareRenderer() const
+{
+	SDL_RendererInfo info;
+
+	if (SDL_GetRendererInfo(mp_Renderer, &info) < 0)
+		return false;
+
+	return (info.flags & SDL_RENDERER_SOFTWARE) != 0;
+}
+
+void Graphics::SetRenderTarget(Texture *texture) noexcept(false)
+{
+	if (texture == nullptr)
+		texture = mp_Offscreen;
+	if (SDL_SetRenderTarget(mp_Renderer, texture != nullptr ? texture->Tex() : nullptr) < 0)
+		throw std::runtime_error(SDL_GetError());
 }
 
 void Graphics::Present()
 {
+	if (mp_Blitter != nullptr)
+		mp_Blitter->Upload();
+
+	if (mp_Offscreen != nullptr) {
+		// the one scaled copy of the frame to the window
+		SDL_SetRenderTarget(mp_Renderer, nullptr);
+		SDL_RenderCopy(mp_Renderer, mp_Offscreen->Tex(), nullptr, nullptr);
+	}
+
+	m_FrameTime = static_cast<double>(SDL_GetPerformanceCounter() - m_FrameStart) /
+		SDL_GetPerformanceFrequency();
 	SDL_RenderPresent(mp_Renderer);
+
+	if (mp_Offscreen != nullptr)
+		SDL_SetRenderTarget(mp_Renderer, mp_Offscreen->Tex());
 }
 
 void Graphics::RenderCopy(Texture *texture, GRect const* srcrect,
 			GRect const* dstrect) noexcept(false) {
+	if (mp_Blitter != nullptr) {
+		RenderCopyEx(texture, srcrect, dstrect, 0);
+		return;
+	}
 	if (SDL_RenderCopy(mp_Renderer, texture->Tex(), srcrect, dstrect) < 0)
 		throw std::runtime_error(SDL_GetError());
 }
 
 void Graphics::RenderCopyEx(Texture *texture, GRect const* srcrect, GRect const* dstrect,
 			const double angle, GPoint const* center) noexcept(false) {
+	if (mp_Blitter != nullptr) {
+		GRect const whole { 0, 0, texture->Width(), texture->Height() };
+		GRect const frame { 0, 0, m_Viewport.w, m_Viewport.h };
+		mp_Blitter->Draw(texture, srcrect != nullptr ? *srcrect : whole,
+				dstrect != nullptr ? *dstrect : frame, angle, center);
+		return;
+	}
 	if (SDL_RenderCopyEx(mp_Renderer, texture->Tex(), srcrect, dstrect, angle, center, SDL_FLIP_NONE) < 0)
 		throw std::runtime_error(SDL_GetError());
 }
 
+#if ENGINE_HAVE_GEOMETRY
+void Graphics::RenderGeometry(Texture *texture, GVertex const* vertices, int numvertices,
+			int const* indices, int numindices) noexcept(false) {
+	if (SDL_RenderGeometry(mp_Renderer, texture->Tex(), vertices, numvertices, indices, numindices) < 0)
+		throw std::runtime_error(SDL_GetError());
+}
+#endif
+
 Graphics::~Graphics() {
+	delete mp_Blitter;
+	mp_Blitter = nullptr;
+	delete mp_Offscreen;
+	mp_Offscreen = nullptr;
 	if (mp_Window != nullptr) {
 		SDL_DestroyWindow(mp_Window);
 		mp_Window = nullptr;
@@ -0,0 +1,273 @@
+/* ImageCache.cpp - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * Keeps decoded images on disk, next to their sources, so that later runs
+ * can skip decoding.
+ */
+
+#include <SDL2/SDL.h>
+
+#include "engine/ImageCache.h"
+
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Engine {
+
+namespace {
+
+// bump when the layout below changes, old files are then just rewritten
+constexpr Uint32 cacheVersion = 2;
+
+// 64 bytes so that pixels stay aligned in the mapping
+struct Header {
+	char magic[4];
+	Uint32 version;
+	Uint32 format;
+	Sint32 width;
+	Sint32 height;
+	Sint32 pitch;
+	Uint64 sourceSize;
+	Uint64 sourceHash;
+	// of the step that made the pixels, see Texture::Prepare
+	Uint64 key;
+	Uint8 reserved[16];
+};
+
+static_assert(sizeof(Header) == 64, "ImageCache header must be 64 bytes");
+
+char const magic[4] = { 'J', 'M', 'T', 'C' };
+
+// kept in the userdata of the surfaces made from a mapping
+struct Mapping {
+	void *base;
+	size_t size;
+};
+
+std::string CacheName(std::string const& source)
+{
+	return source + ".texcache";
+}
+
+Mapping* Map(std::string const& filename)
+{
+	Mapping *mapping = nullptr;
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return nullptr;
+
+	LARGE_INTEGER size;
+	HANDLE view = nullptr;
+	if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+		view = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+
+	if (view != nullptr) {
+		// copy on write, since surfaces are not meant to be read-only
+		void *base = MapViewOfFile(view, FILE_MAP_COPY, 0, 0, 0);
+		if (base != nullptr)
+			mapping = new Mapping{base, static_cast<size_t>(size.QuadPart)};
+		CloseHandle(view);
+	}
+	CloseHandle(file);
+#else
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return nullptr;
+
+	struct stat st;
+	if (fstat(fd, &st) == 0 && st.st_size > 0) {
+		// private mapping, so that writing to the surface never hits the file
+		void *base = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		if (base != MAP_FAILED)
+			mapping = new Mapping{base, static_cast<size_t>(st.st_size)};
+	}
+	close(fd);
+#endif
+	return mapping;
+}
+
+// checks everything but the source of a cache of the given size
+bool Valid(Header const& header, size_t size)
+{
+	return size >= sizeof(Header) &&
+		std::memcmp(header.magic, magic, sizeof(magic)) == 0 &&
+		header.version == cacheVersion &&
+		header.width > 0 && header.height > 0 && header.pitch >= header.width * 4 &&
+		size - sizeof(Header) >= static_cast<size_t>(header.pitch) * header.height;
+}
+
+// a surface over the pixels described by the header
+SDL_Surface* Surface(Header const& header, void const* pixels)
+{
+	int bpp;
+	Uint32 rmask, gmask, bmask, amask;
+
+	if (!SDL_PixelFormatEnumToMasks(header.format, &bpp, &rmask, &gmask, &bmask, &amask))
+		return nullptr;
+
+	// surfaces are never written to, but SDL wants them writable
+	return SDL_CreateRGBSurfaceFrom(const_cast<void*>(pixels),
+			header.width, header.height, bpp, header.pitch, rmask, gmask, bmask, amask);
+}
+
+void Unmap(Mapping *mapping)
+{
+#ifdef _WIN32
+	UnmapViewOfFile(mapping->base);
+#else
+	munmap(mapping->base, mapping->size);
+#endif
+	delete mapping;
+}
+
+}	// anonymous namespace
+
+// hashes the source image, safe to use from any thread
+ImageCache::ImageCache(std::string const& source) :
+		m_Filename{CacheName(source)}, m_Hashed{false}, m_SourceSize{0}, m_SourceHash{0}
+{
+	SDL_RWops *rw = SDL_RWFromFile(source.c_str(), "rb");
+
+	if (rw == nullptr)
+		return;
+
+	// FNV-1a, plenty for telling two versions of an image apart
+	std::vector<Uint8> chunk(64 * 1024);
+	Uint64 hash = 14695981039346656037ULL;
+	size_t read;
+
+	while ((read = SDL_RWread(rw, chunk.data(), 1, chunk.size())) > 0) {
+		for (size_t i = 0; i < read; ++i) {
+			hash ^= chunk[i];
+			hash *= 1099511628211ULL;
+		}
+		m_SourceSize += read;
+	}
+
+	SDL_RWclose(rw);
+
+	m_SourceHash = hash;
+	m_Hashed = true;
+}
+
+// maps the cached pixels into a surface, or nullptr if missing or stale
+SDL_Surface* ImageCache::Load(Uint64 *key)
+{
+	if (!m_Hashed)
+		return nullptr;
+
+	Mapping *mapping = Map(m_Filename);
+
+	if (mapping == nullptr)
+		return nullptr;
+
+	Header const& header = *static_cast<Header const*>(mapping->base);
+	SDL_Surface *surface = nullptr;
+
+	if (Valid(header, mapping->size) &&
+			header.sourceSize == m_SourceSize && header.sourceHash == m_SourceHash)
+		surface = Surface(header, &header + 1);
+
+	if (surface == nullptr) {
+		Unmap(mapping);
+		return nullptr;
+	}
+
+	surface->userdata = mapping;
+	if (key != nullptr)
+		*key = header.key;
+
+	return surface;
+}
+
+// a surface over cache contents held in memory, or nullptr if they aren't one
+SDL_Surface* ImageCache::Load(void const* data, std::size_t size, Uint64 *key)
+{
+	Header header;
+
+	if (size < sizeof(Header))
+		return nullptr;
+
+	// copied, since linked in data is only aligned to the start of its section
+	std::memcpy(&header, data, sizeof(Header));
+
+	if (!Valid(header, size))
+		return nullptr;
+
+	if (key != nullptr)
+		*key = header.key;
+
+	return Surface(header, static_cast<Uint8 const*>(data) + sizeof(Header));
+}
+
+// writes a freshly decoded surface and the key of its step, failing silently
+void ImageCache::Store(SDL_Surface const* surface, Uint64 key)
+{
+	if (!m_Hashed || SDL_MUSTLOCK(surface))
+		return;
+
+	Header header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, magic, sizeof(magic));
+	header.version = cacheVersion;
+	header.format = surface->format->format;
+	header.width = surface->w;
+	header.height = surface->h;
+	header.pitch = surface->pitch;
+	header.sourceSize = m_SourceSize;
+	header.sourceHash = m_SourceHash;
+	header.key = key;
+
+	// written aside and renamed, so that a half written cache is never mapped
+	std::string const partial = m_Filename + ".part";
+	SDL_RWops *rw = SDL_RWFromFile(partial.c_str(), "wb");
+
+	if (rw == nullptr)
+		return;
+
+	size_t const pixels = static_cast<size_t>(surface->pitch) * surface->h;
+	bool written = SDL_RWwrite(rw, &header, sizeof(header), 1) == 1 &&
+		SDL_RWwrite(rw, surface->pixels, pixels, 1) == 1;
+
+	if (SDL_RWclose(rw) != 0)
+		written = false;
+
+	// rename() won't replace an existing file everywhere
+	if (written) {
+		std::remove(m_Filename.c_str());
+		written = std::rename(partial.c_str(), m_Filename.c_str()) == 0;
+	}
+
+	if (!written)
+		std::remove(partial.c_str());
+}
+
+// frees a surface, unmapping its pixels if they came from a cache file
+void ImageCache::FreeSurface(SDL_Surface *surface)
+{
+	if (surface == nullptr)
+		return;
+
+	// only surfaces made by Load() have both of these
+	Mapping *mapping = (surface->flags & SDL_PREALLOC) ?
+		static_cast<Mapping*>(surface->userdata) : nullptr;
+
+	SDL_FreeSurface(surface);
+
+	if (mapping != nullptr)
+		Unmap(mapping);
+}
+
+}	// Engine
@@ -0,0 +1,85 @@
+/* ImageLoader.cpp - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * Decodes a set of image files in parallel, one worker thread per file, into
+ * surfaces ready to be handed to Textures.
+ */
+
+#include <SDL2/SDL.h>
+
+#include "engine/Texture.h"
+#include "engine/ImageCache.h"
+
+#include "engine/ImageLoader.h"
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+namespace Engine {
+
+ImageLoader::ImageLoader(std::vector<Source> const& sources) noexcept(false) :
+		m_Jobs(sources.size(), Job{Source{""}, nullptr, nullptr, "", 0})
+{
+	for (std::vector<Job>::size_type i = 0; i < m_Jobs.size(); ++i) {
+		Job& job = m_Jobs[i];
+
+		job.source = sources[i];
+		job.surface = nullptr;
+		job.seconds = 0;
+		job.thread = SDL_CreateThread(ImageLoader::Run, "ImageLoader", &job);
+
+		// no threads, no problem: just decode right away instead
+		if (job.thread == nullptr)
+			Run(&job);
+	}
+}
+
+ImageLoader::~ImageLoader()
+{
+	for (auto& job : m_Jobs) {
+		if (job.thread != nullptr)
+			SDL_WaitThread(job.thread, nullptr);
+		if (job.surface != nullptr)
+			ImageCache::FreeSurface(job.surface);
+	}
+}
+
+int ImageLoader::Run(void *data)
+{
+	Job& job = *static_cast<Job*>(data);
+	Uint64 const start = SDL_GetPerformanceCounter();
+
+	try {
+		if (job.source.data != nullptr)
+			job.surface = Texture::Decode(job.source.data, job.source.size, job.source.prepare);
+		else
+			job.surface = Texture::Decode(job.source.name, job.source.prepare);
+	} catch (std::exception &e) {
+		job.error = e.what();
+	}
+
+	job.seconds = static_cast<double>(SDL_GetPerformanceCounter() - start) /
+		SDL_GetPerformanceFrequency();
+
+	return 0;
+}
+
+SDL_Surface* ImageLoader::Take(std::vector<Source>::size_type index) noexcept(false)
+{
+	Job& job = m_Jobs[index];
+
+	if (job.thread != nullptr) {
+		SDL_WaitThread(job.thread, nullptr);
+		job.thread = nullptr;
+	}
+
+	if (job.surface == nullptr)
+		throw std::runtime_error(job.source.name + ": " + job.error);
+
+	SDL_Surface *surface = job.surface;
+	job.surface = nullptr;
+
+	return surface;
+}
+
+}	// Engine
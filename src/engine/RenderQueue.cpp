@@ -0,0 +1,131 @@
+/* RenderQueue.cpp - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * A RenderQueue collects the sprites of a whole frame, each one tagged with
+ * a layer, texture, clipping rectangle and alpha, and on Flush() sorts them
+ * into the fewest state changes before handing them to a SpriteBatcher.
+ */
+
+#include "engine/Graphics.h"
+#include "engine/Texture.h"
+#include "engine/TextureRegion.h"
+#include "engine/SpriteBatcher.h"
+#include "engine/RotationCache.h"
+
+#include "engine/RenderQueue.h"
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+#include <vector>
+
+namespace Engine {
+
+RenderQueue::RenderQueue(Graphics *g) : m_SB{g}, mp_Rotations{nullptr}, m_Layer{0},
+		m_Clipped{false}, m_Clip{}, m_Items{}, m_Order{}, m_Stats{} {}
+
+void RenderQueue::Layer(int layer, GRect const* clip)
+{
+	m_Layer = layer;
+	m_Clipped = clip != nullptr;
+	// unclipped sprites get an empty rect so that they compare equal
+	m_Clip = m_Clipped ? *clip : GRect{};
+}
+
+void RenderQueue::DrawSprite(GRect const& dest, TextureRegion const& region,
+		double angle, double alpha, GPoint const* center)
+{
+	Item item;
+
+	// done here so that the cached copies get sorted by their own texture
+	if (mp_Rotations != nullptr && angle != 0 && center == nullptr) {
+		TextureRegion const* rotated = &region;
+		GRect rotateddest = dest;
+
+		if (mp_Rotations->Lookup(rotated, rotateddest, angle)) {
+			DrawSprite(rotateddest, *rotated, angle, alpha);
+			return;
+		}
+	}
+
+	item.layer = m_Layer;
+	item.texture = region.Tex();
+	item.clipped = m_Clipped;
+	item.clip = m_Clip;
+	// alpha modulation is 8 bits wide, so that is what makes a difference
+	item.alpha = static_cast<unsigned char>(alpha * 255);
+	item.dest = dest;
+	item.region = &region;
+	item.angle = angle;
+	item.alphaf = alpha;
+	item.centered = center != nullptr;
+	if (item.centered)
+		item.center = *center;
+
+	m_Items.push_back(item);
+}
+
+bool RenderQueue::SameClip(Item const& a, Item const& b)
+{
+	if (a.clipped != b.clipped)
+		return false;
+
+	return !a.clipped || (a.clip.x == b.clip.x && a.clip.y == b.clip.y &&
+			a.clip.w == b.clip.w && a.clip.h == b.clip.h);
+}
+
+bool RenderQueue::Before(Item const& a, Item const& b)
+{
+	if (a.layer != b.layer)
+		return a.layer < b.layer;
+	if (a.texture != b.texture)
+		return std::less<Texture*>()(a.texture, b.texture);
+
+	return std::make_tuple(a.clipped, a.clip.x, a.clip.y, a.clip.w, a.clip.h, a.alpha) <
+		std::make_tuple(b.clipped, b.clip.x, b.clip.y, b.clip.w, b.clip.h, b.alpha);
+}
+
+void RenderQueue::Flush() noexcept(false)
+{
+	m_Stats = Stats{};
+	m_Stats.sprites = m_Items.size();
+
+	m_Order.resize(m_Items.size());
+	for (unsigned int i = 0; i < m_Order.size(); ++i)
+		m_Order[i] = i;
+
+	std::stable_sort(m_Order.begin(), m_Order.end(),
+		[this](unsigned int a, unsigned int b) {
+			return Before(m_Items[a], m_Items[b]);
+		});
+
+	Item const* last = nullptr;
+
+	for (auto const index : m_Order) {
+		Item const& item = m_Items[index];
+
+		if (last == nullptr || last->texture != item.texture || !SameClip(*last, item)) {
+			if (last != nullptr) {
+				m_SB.EndBatch();
+				if (last->texture != item.texture)
+					++m_Stats.textureChanges;
+				if (!SameClip(*last, item))
+					++m_Stats.clipChanges;
+			}
+			m_SB.BeginBatch(item.texture, item.clipped ? &item.clip : nullptr);
+			++m_Stats.batches;
+		} else if (last->alpha != item.alpha) {
+			++m_Stats.alphaChanges;
+		}
+
+		m_SB.DrawSprite(item.dest, *item.region, item.angle, item.alphaf,
+				item.centered ? &item.center : nullptr);
+		last = &item;
+	}
+
+	if (last != nullptr)
+		m_SB.EndBatch();
+
+	m_Items.clear();
+}
+
+}	// Engine
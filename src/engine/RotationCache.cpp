@@ -0,0 +1,123 @@
+/* RotationCache.cpp - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * Pre-renders a set of TextureRegions at a number of evenly spaced angles into
+ * an auxiliary texture, so that rotated sprites can be drawn as plain copies of
+ * the nearest pre-rotated version.
+ */
+
+#include <SDL2/SDL.h>
+
+#include "engine/Graphics.h"
+#include "engine/Texture.h"
+#include "engine/TextureRegion.h"
+
+#include "engine/RotationCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <stdexcept>
+
+namespace Engine {
+
+// side of the square that fits a region at any angle
+static int diagonal(TextureRegion const& region)
+{
+	return static_cast<int>(std::ceil(std::sqrt(region.Width() * region.Width() +
+		region.Height() * region.Height())));
+}
+
+RotationCache::RotationCache(Graphics& g, std::vector<TextureRegion const*> const& regions,
+		int steps) noexcept(false) : mp_Texture{nullptr}, m_Steps{steps},
+		m_Sources(regions), m_Rotated{}
+{
+	int cell = 0;
+
+	for (auto region : m_Sources)
+		cell = std::max(cell, diagonal(*region));
+
+	// lay out cells in a roughly square grid
+	int const cells = m_Sources.size() * (m_Steps - 1);
+	int const columns = static_cast<int>(std::ceil(std::sqrt(cells)));
+	int const rows = (cells + columns - 1) / columns;
+
+	mp_Texture = new Texture(columns * cell, rows * cell, g.GetRenderer());
+	SDL_SetTextureBlendMode(mp_Texture->Tex(), SDL_BLENDMODE_BLEND);
+
+	try {
+		g.SetRenderTarget(mp_Texture);
+		SDL_SetRenderDrawColor(g.GetRenderer(), 0, 0, 0, 0);
+		g.Clear();
+
+		for (auto region : m_Sources) {
+			// copy pixels as they are, alpha included, instead of blending
+			SDL_SetTextureBlendMode(region->Tex()->Tex(), SDL_BLENDMODE_NONE);
+
+			int const side = diagonal(*region);
+			GRect const src = region->Rect();
+
+			for (int step = 1; step < m_Steps; ++step) {
+				int const index = m_Rotated.size();
+				int const x = (index % columns) * cell;
+				int const y = (index / columns) * cell;
+				GRect dst;
+
+				dst.x = x + (side - src.w) / 2;
+				dst.y = y + (side - src.h) / 2;
+				dst.w = src.w;
+				dst.h = src.h;
+				g.RenderCopyEx(region->Tex(), &src, &dst, 360.0 * step / m_Steps);
+				m_Rotated.emplace_back(mp_Texture, x, y, side, side);
+			}
+
+			SDL_SetTextureBlendMode(region->Tex()->Tex(), SDL_BLENDMODE_BLEND);
+		}
+
+		SDL_SetRenderDrawColor(g.GetRenderer(), 0, 0, 0, 255);
+		g.SetRenderTarget(nullptr);
+	} catch (std::exception &e) {
+		delete mp_Texture;
+		throw;
+	}
+}
+
+RotationCache::~RotationCache()
+{
+	delete mp_Texture;
+}
+
+bool RotationCache::Lookup(TextureRegion const*& region, GRect& dest, double& angle) const
+{
+	auto const it = std::find(m_Sources.begin(), m_Sources.end(), region);
+
+	if (it == m_Sources.end())
+		return false;
+
+	double normalized = std::fmod(angle, 360.0);
+	if (normalized < 0)
+		normalized += 360.0;
+
+	int const step = static_cast<int>(std::lround(normalized * m_Steps / 360.0)) % m_Steps;
+	angle = 0;
+
+	// close enough to not rotating at all, so just draw the original
+	if (step == 0)
+		return true;
+
+	TextureRegion const& rotated = m_Rotated[(it - m_Sources.begin()) * (m_Steps - 1) + step - 1];
+	// grow dest around its center as the cell grew around the region
+	double const cx = dest.x + dest.w / 2.0;
+	double const cy = dest.y + dest.h / 2.0;
+	int const w = std::lround(static_cast<double>(dest.w) * rotated.Width() / region->Width());
+	int const h = std::lround(static_cast<double>(dest.h) * rotated.Height() / region->Height());
+
+	dest.x = std::lround(cx - w / 2.0);
+	dest.y = std::lround(cy - h / 2.0);
+	dest.w = w;
+	dest.h = h;
+	region = &rotated;
+
+	return true;
+}
+
+}	// Engine
@@ -0,0 +1,291 @@
+/* ScaleCache.cpp - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * Pre-scales a set of TextureRegions into a chain of smaller copies, each
+ * half the size of the previous one, appended below the pixels of their own
+ * texture as it gets decoded.
+ */
+
+#include <SDL2/SDL.h>
+
+#include "engine/Graphics.h"
+#include "engine/ImageCache.h"
+#include "engine/Texture.h"
+#include "engine/TextureRegion.h"
+
+#include "engine/ScaleCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <stdexcept>
+
+namespace Engine {
+
+// between copies, so that filtering one never reaches another
+static constexpr int gap = 1;
+
+static Uint32& pixel(SDL_Surface *surface, int x, int y)
+{
+	return reinterpret_cast<Uint32*>(static_cast<Uint8*>(surface->pixels) + y * surface->pitch)[x];
+}
+
+/* averages the pixels of src covering each one of dst, weighting colors by
+ * alpha so that transparent pixels don't darken edges
+ */
+static void downscale(SDL_Surface *surface, GRect const& src, GRect const& dst)
+{
+	SDL_PixelFormat const* format = surface->format;
+	Uint8 const shifts[4] = { format->Rshift, format->Gshift, format->Bshift, format->Ashift };
+
+	for (int y = 0; y < dst.h; ++y) {
+		int const y0 = src.y + y * src.h / dst.h;
+		int const y1 = std::max(y0 + 1, src.y + (y + 1) * src.h / dst.h);
+
+		for (int x = 0; x < dst.w; ++x) {
+			int const x0 = src.x + x * src.w / dst.w;
+			int const x1 = std::max(x0 + 1, src.x + (x + 1) * src.w / dst.w);
+			Uint32 sums[3] = { 0, 0, 0 };
+			Uint32 alpha = 0;
+			Uint32 result = 0;
+
+			for (int sy = y0; sy < y1; ++sy) {
+				for (int sx = x0; sx < x1; ++sx) {
+					Uint32 const p = pixel(surface, sx, sy);
+					Uint32 const a = (p >> shifts[3]) & 0xff;
+
+					for (int c = 0; c < 3; ++c)
+						sums[c] += ((p >> shifts[c]) & 0xff) * a;
+					alpha += a;
+				}
+			}
+
+			if (alpha > 0) {
+				int const count = (x1 - x0) * (y1 - y0);
+
+				for (int c = 0; c < 3; ++c)
+					result |= ((sums[c] + alpha / 2) / alpha) << shifts[c];
+				result |= ((alpha + count / 2) / count) << shifts[3];
+			}
+
+			pixel(surface, dst.x + x, dst.y + y) = result;
+		}
+	}
+}
+
+ScaleCache::ScaleCache(std::vector<Page> const& pages, std::vector<Source> const& sources) noexcept(false) :
+		m_Chains{}, m_Layouts{}
+{
+	for (auto const& source : sources) {
+		Chain chain { source.region->Tex(), source.region->Rect(),
+			source.cellWidth, source.cellHeight, {} };
+		int w = source.cellWidth, h = source.cellHeight;
+
+		while (w / 2 >= minimumSide && h / 2 >= minimumSide) {
+			w /= 2;
+			h /= 2;
+			chain.levels.push_back(Level{ GRect{}, w, h });
+		}
+
+		if (!chain.levels.empty())
+			m_Chains.push_back(chain);
+	}
+
+	for (auto const& page : pages) {
+		std::vector<Chain*> chains;
+
+		for (auto& chain : m_Chains)
+			if (chain.texture == page.texture)
+				chains.push_back(&chain);
+
+		if (!chains.empty())
+			m_Layouts.push_back(Place(page, chains));
+	}
+
+	for (auto const& chain : m_Chains)
+		if (chain.levels.front().rect.w == 0)
+			throw std::runtime_error("ScaleCache: region out of the pages given");
+}
+
+// places the copies of the chains on page below its pixels
+ScaleCache::Layout ScaleCache::Place(Page const& page, std::vector<Chain*> const& chains) noexcept(false)
+{
+	// shelves of copies below the original pixels
+	int x = 0, y = page.height + gap, shelf = 0;
+
+	for (auto chain : chains) {
+		int const columns = chain->source.w / chain->cellWidth;
+		int const rows = chain->source.h / chain->cellHeight;
+
+		for (auto& level : chain->levels) {
+			int const w = columns * level.cellWidth;
+			int const h = rows * level.cellHeight;
+
+			if (w > page.width)
+				throw std::runtime_error("ScaleCache: region wider than its page");
+
+			if (x + w > page.width) {
+				x = 0;
+				y += shelf + gap;
+				shelf = 0;
+			}
+
+			level.rect = GRect{ x, y, w, h };
+			x += w + gap;
+			shelf = std::max(shelf, h);
+		}
+	}
+
+	return Layout{ page, y + shelf };
+}
+
+ScaleCache::Layout const* ScaleCache::Find(Texture const* texture) const
+{
+	for (auto const& layout : m_Layouts)
+		if (layout.page.texture == texture)
+			return &layout;
+
+	return nullptr;
+}
+
+// the image of texture with the copies below its pixels, made unless it has them
+SDL_Surface* ScaleCache::Extend(Texture const* texture, SDL_Surface *surface, bool prepared) const noexcept(false)
+{
+	Layout const* layout = Find(texture);
+
+	// nothing to scale on this one
+	if (layout == nullptr)
+		return surface;
+
+	if (surface->format->BytesPerPixel != 4 || surface->w != layout->page.width)
+		throw std::runtime_error("ScaleCache needs the 32 bit image of the texture");
+
+	if (prepared && surface->h == layout->height)
+		return surface;
+
+	// copies made for another layout, if any, are below the page and get dropped
+	if (surface->h < layout->page.height)
+		throw std::runtime_error("ScaleCache: image smaller than its page");
+
+	SDL_PixelFormat const* format = surface->format;
+	SDL_Surface *scaled = SDL_CreateRGBSurface(0, layout->page.width, layout->height, 32,
+			format->Rmask, format->Gmask, format->Bmask, format->Amask);
+
+	if (scaled == nullptr)
+		throw std::runtime_error(SDL_GetError());
+
+	SDL_FillRect(scaled, nullptr, 0);
+	SDL_LockSurface(surface);
+	for (int row = 0; row < layout->page.height; ++row)
+		std::memcpy(static_cast<Uint8*>(scaled->pixels) + row * scaled->pitch,
+			static_cast<Uint8 const*>(surface->pixels) + row * surface->pitch, surface->w * 4);
+	SDL_UnlockSurface(surface);
+
+	// each level is averaged from the previous one, cell by cell
+	for (auto const& chain : m_Chains) {
+		if (chain.texture != texture)
+			continue;
+
+		int const columns = chain.source.w / chain.cellWidth;
+		int const rows = chain.source.h / chain.cellHeight;
+		GRect from = chain.source;
+		int fromw = chain.cellWidth, fromh = chain.cellHeight;
+
+		for (auto const& level : chain.levels) {
+			for (int row = 0; row < rows; ++row) {
+				for (int column = 0; column < columns; ++column) {
+					GRect const src { from.x + column * fromw, from.y + row * fromh, fromw, fromh };
+					GRect const dst { level.rect.x + column * level.cellWidth,
+						level.rect.y + row * level.cellHeight, level.cellWidth, level.cellHeight };
+
+					downscale(scaled, src, dst);
+				}
+			}
+
+			from = level.rect;
+			fromw = level.cellWidth;
+			fromh = level.cellHeight;
+		}
+	}
+
+	ImageCache::FreeSurface(surface);
+
+	return scaled;
+}
+
+// a hash of where the copies of texture go, see Texture::Prepare
+Uint64 ScaleCache::Key(Texture const* texture) const
+{
+	Layout const* layout = Find(texture);
+	// FNV-1a over the layout, which also depends on the regions scaled
+	Uint64 hash = 14695981039346656037ULL;
+	auto const mix = [&hash] (int value) {
+		for (int i = 0; i < 4; ++i) {
+			hash ^= (static_cast<Uint32>(value) >> (i * 8)) & 0xff;
+			hash *= 1099511628211ULL;
+		}
+	};
+
+	if (layout == nullptr)
+		return 0;
+
+	mix(layout->page.width);
+	mix(layout->page.height);
+	mix(layout->height);
+	for (auto const& chain : m_Chains) {
+		if (chain.texture != texture)
+			continue;
+
+		mix(chain.source.x);
+		mix(chain.source.y);
+		mix(chain.source.w);
+		mix(chain.source.h);
+		mix(chain.cellWidth);
+		mix(chain.cellHeight);
+		for (auto const& level : chain.levels) {
+			mix(level.rect.x);
+			mix(level.rect.y);
+			mix(level.rect.w);
+			mix(level.rect.h);
+			mix(level.cellWidth);
+			mix(level.cellHeight);
+		}
+	}
+
+	// zero stands for no step at all
+	return hash != 0 ? hash : 1;
+}
+
+bool ScaleCache::Lookup(Texture const* texture, GRect& src, int width, int height) const
+{
+	for (auto const& chain : m_Chains) {
+		int const dx = src.x - chain.source.x;
+		int const dy = src.y - chain.source.y;
+
+		if (chain.texture != texture || src.w != chain.cellWidth || src.h != chain.cellHeight ||
+				dx < 0 || dy < 0 || dx >= chain.source.w || dy >= chain.source.h ||
+				dx % chain.cellWidth != 0 || dy % chain.cellHeight != 0)
+			continue;
+
+		Level const* best = nullptr;
+
+		for (auto const& level : chain.levels) {
+			if (level.cellWidth < width || level.cellHeight < height)
+				break;
+			best = &level;
+		}
+
+		if (best == nullptr)
+			return false;
+
+		src.x = best->rect.x + dx / chain.cellWidth * best->cellWidth;
+		src.y = best->rect.y + dy / chain.cellHeight * best->cellHeight;
+		src.w = best->cellWidth;
+		src.h = best->cellHeight;
+
+		return true;
+	}
+
+	return false;
+}
+
+}	// Engine
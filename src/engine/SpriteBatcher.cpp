@@ -14,20 +14,24 @@
  */
 
 
+#include "util/Math.h"
+
 #include "engine/Texture.h"
 #include "engine/TextureRegion.h"
 #include "engine/Sprite.h"
 #include "engine/GameObject.h"
+#include "engine/ScaleCache.h"
 
 #include "engine/SpriteBatcher.h"
 
 #include <SDL2/SDL.h>
 
 #include <stdexcept>
+#include <cmath>
 
 namespace Engine {
 
-void SpriteBatcher::BeginBatch(Texture *texture, GRect *visible)
+void SpriteBatcher::BeginBatch(Texture *texture, GRect const* visible)
 {
 	mp_Texture = texture;
 	mp_Visible = visible;
@@ -35,6 +39,79 @@ void SpriteBatcher::BeginBatch(Texture *texture, GRect *visible)
 }
 
 void SpriteBatcher::EndBatch() noexcept(false) {
+	// the CPU blitter clips exactly, and per sprite calls cost it nothing
+	if (m_G->UsingBlitter()) {
+		m_G->SetClipRect(mp_Visible);
+		EndBatchCopies();
+		m_G->SetClipRect(nullptr);
+		return;
+	}
+
+#if ENGINE_HAVE_GEOMETRY
+	EndBatchGeometry();
+#else
+	EndBatchCopies();
+#endif
+}
+
+#if ENGINE_HAVE_GEOMETRY
+// turns the whole queue into a vertex/index buffer drawn in one call
+void SpriteBatcher::EndBatchGeometry() noexcept(false) {
+	float const texw = mp_Texture->Width();
+	float const texh = mp_Texture->Height();
+
+	if (m_Sprites.empty())
+		return;
+
+	m_Vertices.clear();
+	m_Indices.clear();
+	m_Vertices.reserve(m_Sprites.size() * 4);
+	m_Indices.reserve(m_Sprites.size() * 6);
+
+	for (auto& sprite : m_Sprites) {
+		GRect const& dst = *sprite.DstRect();
+		GRect const& src = *sprite.SrcRect();
+		GPoint const& center = *sprite.Center();
+		SDL_Color const color { 255, 255, 255, static_cast<Uint8>(sprite.Alpha() * 255) };
+		int const base = m_Vertices.size();
+
+		// corners clockwise from top left, as offsets from the rotation center
+		float const cx = dst.x + center.x;
+		float const cy = dst.y + center.y;
+		float const xs[4] = { dst.x - cx, dst.x + dst.w - cx, dst.x + dst.w - cx, dst.x - cx };
+		float const ys[4] = { dst.y - cy, dst.y - cy, dst.y + dst.h - cy, dst.y + dst.h - cy };
+		float const us[4] = { src.x / texw, (src.x + src.w) / texw, (src.x + src.w) / texw, src.x / texw };
+		float const vs[4] = { src.y / texh, src.y / texh, (src.y + src.h) / texh, (src.y + src.h) / texh };
+		float cos = 1, sin = 0;
+
+		if (sprite.Angle() != 0) {
+			double rad = Util::to_radians(sprite.Angle());
+			cos = std::cos(rad);
+			sin = std::sin(rad);
+		}
+
+		for (int i = 0; i < 4; ++i) {
+			GVertex v;
+			v.position.x = cx + xs[i] * cos - ys[i] * sin;
+			v.position.y = cy + xs[i] * sin + ys[i] * cos;
+			v.color = color;
+			v.tex_coord.x = us[i];
+			v.tex_coord.y = vs[i];
+			m_Vertices.push_back(v);
+		}
+
+		int const quad[6] = { 0, 1, 2, 0, 2, 3 };
+		for (auto const i : quad)
+			m_Indices.push_back(base + i);
+	}
+
+	m_G->RenderGeometry(mp_Texture, m_Vertices.data(), m_Vertices.size(),
+			m_Indices.data(), m_Indices.size());
+}
+#endif
+
+// draws sprites one by one, switching the texture's alpha as needed
+void SpriteBatcher::EndBatchCopies() noexcept(false) {
 	double texAlpha, lastAlpha;
 
 	texAlpha = lastAlpha = mp_Texture->Alpha();
@@ -45,7 +122,11 @@ void SpriteBatcher::EndBatch() noexcept(false) {
 			lastAlpha = alpha;
 			mp_Texture->Alpha(alpha);
 		}
-		m_G->RenderCopyEx(mp_Texture, sprite.SrcRect(), sprite.DstRect(), sprite.Angle(), sprite.Center());
+		// some renderers take a much slower path for any RenderCopyEx()
+		if (sprite.Angle() == 0)
+			m_G->RenderCopy(mp_Texture, sprite.SrcRect(), sprite.DstRect());
+		else
+			m_G->RenderCopyEx(mp_Texture, sprite.SrcRect(), sprite.DstRect(), sprite.Angle(), sprite.Center());
 	}
 
 	// reset the alpha on the texture to the original value
@@ -53,35 +134,21 @@ void SpriteBatcher::EndBatch() noexcept(false) {
 		mp_Texture->Alpha(texAlpha);
 }
 
-void SpriteBatcher::DrawSprite(GameObject const& obj, GPoint const* center) {
-	TextureRegion const* region = obj.Region();
-	// objects that don't have a region assigned are ignored
-	if (region != nullptr)
-		DrawSprite(obj.Rect(), *region, obj.Angle(), obj.Alpha(), center);
-}
-
-void SpriteBatcher::DrawSprite(int x, int y, int width, int height,
+void SpriteBatcher::DrawSprite(GRect const& dest,
 		TextureRegion const& region, double angle, double alpha, GPoint const* center)
 {
-	GRect dest;
-	dest.x = x;
-	dest.y = y;
-	dest.w = width;
-	dest.h = height;
+	GRect src = region.Rect();
 
-	DrawSprite(dest, region, angle, alpha, center);
-}
+	if (mp_Scales != nullptr)
+		mp_Scales->Lookup(region.Tex(), src, dest.w, dest.h);
 
-void SpriteBatcher::DrawSprite(GRect const& dest,
-		TextureRegion const& region, double angle, double alpha, GPoint const* center)
-{
 	/* if there's a visibility rectangle set, we have to adjust
 	 * the relation between dest and the source region, ie:
 	 * _______      _______
 	 * |   __|  =>  |_|   |
 	 * |___|_|  =>  |_____|
 	 */
-	if (mp_Visible != nullptr) {
+	if (mp_Visible != nullptr && !m_G->UsingBlitter()) {
 		/* Rectangle */
 		GRect visible;
 
@@ -93,7 +160,6 @@ void SpriteBatcher::DrawSprite(GRect const& dest,
 			 * a partially hidden object.
 			 */
 			GPoint cnt;
-			GRect src = region.Rect();
 			double scalex = static_cast<double>(src.w) / static_cast<double>(dest.w);
 			double scaley = static_cast<double>(src.h) / static_cast<double>(dest.h);
 			src.x += (visible.x - dest.x) * scalex;
@@ -128,7 +194,7 @@ void SpriteBatcher::DrawSprite(GRect const& dest,
 		// No intersection means no visibility of this object, so skip it
 
 	} else {
-		m_Sprites.emplace_back(dest, region.Rect(), angle, alpha, center);
+		m_Sprites.emplace_back(dest, src, angle, alpha, center);
 	}
 }
 
@@ -0,0 +1,110 @@
+/* TextRun.cpp - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * A TextRun is a line of text laid out once into the sprites of its glyphs,
+ * for labels that are drawn every frame but rarely change, if ever.
+ */
+
+#include "engine/Font.h"
+#include "engine/TextureRegion.h"
+#include "engine/SpriteTarget.h"
+#include "engine/Vector2.h"
+
+#include "engine/TextRun.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Engine {
+
+TextRun::TextRun(Font const& font, double scale) :
+		mp_Font{&font}, m_Text{}, m_Scale{scale},
+		m_Position{}, m_Cursor{}, m_Glyphs{} {}
+
+void TextRun::Text(char const* text, std::size_t length)
+{
+	std::size_t from = 0;
+
+	while (from < length && from < m_Text.size() && text[from] == m_Text[from])
+		++from;
+
+	if (from == length && length == m_Text.size())
+		return;
+
+	m_Text.assign(text, length);
+	Layout(from);
+}
+
+// sets the text to a number, without going through a std::string
+void TextRun::Number(int number)
+{
+	char digits[12];
+	char *first = digits + sizeof(digits);
+	unsigned int value = number < 0 ? 0U - number : number;
+
+	do {
+		*--first = '0' + value % 10;
+		value /= 10;
+	} while (value > 0);
+
+	if (number < 0)
+		*--first = '-';
+
+	Text(first, digits + sizeof(digits) - first);
+}
+
+void TextRun::Scale(double scale)
+{
+	if (scale == m_Scale)
+		return;
+
+	m_Scale = scale;
+	Layout(0);
+}
+
+void TextRun::Position(Vector2<int> const& position)
+{
+	if (position.X() == m_Position.X() && position.Y() == m_Position.Y())
+		return;
+
+	m_Position = position;
+	Layout(0);
+}
+
+void TextRun::Draw(SpriteTarget& target) const
+{
+	double const alpha = mp_Font->Alpha();
+
+	for (auto const& glyph : m_Glyphs) {
+		if (glyph.region != nullptr)
+			target.DrawSprite(glyph.dest, *glyph.region, 0, alpha);
+	}
+}
+
+// lays out the glyphs of the text from the given one on
+void TextRun::Layout(std::size_t from)
+{
+	int const width = mp_Font->GlyphWidth(m_Scale);
+	int const height = mp_Font->GlyphHeight(m_Scale);
+	int x = m_Position.X();
+
+	// characters the font doesn't have take no room, like in Font::DrawText
+	if (from > 0) {
+		Glyph const& last = m_Glyphs[from - 1];
+		x = last.dest.x + (last.region != nullptr ? width : 0);
+	}
+
+	m_Glyphs.resize(m_Text.size());
+	for (std::size_t i = from; i < m_Text.size(); ++i) {
+		Glyph& glyph = m_Glyphs[i];
+
+		glyph.region = mp_Font->Glyph(m_Text[i]);
+		glyph.dest = GRect{ x, m_Position.Y(), width, height };
+		if (glyph.region != nullptr)
+			x += width;
+	}
+
+	m_Cursor.Set(x, m_Position.Y());
+}
+
+}	// Engine
@@ -10,17 +10,28 @@
 #include <SDL2/SDL_surface.h>
 #include <SDL2/SDL_image.h>
 
+#include <cstddef>
 #include <string>
+#include <vector>
 #include <stdexcept>
 
+#include "engine/ImageCache.h"
+
 #include "engine/Texture.h"
 
 namespace Engine {
 
+// an empty texture, waiting to Adopt() its pixels
+Texture::Texture() :
+		mp_Renderer{nullptr},
+		mp_Texture{nullptr},
+		mp_Surface{nullptr}, m_Premultiplied{},
+		m_Width{0}, m_Height{0}, m_Alpha{1.0} {}
+
 Texture::Texture(std::string const& filename, SDL_Renderer *renderer) :
 		mp_Renderer{nullptr},
 		mp_Texture{nullptr},
-		mp_Surface{nullptr},
+		mp_Surface{nullptr}, m_Premultiplied{},
 		m_Width{0}, m_Height{0}, m_Alpha{1.0}
 {
 	this->Load(filename);
@@ -28,10 +39,23 @@ Texture::Texture(std::string const& filename, SDL_Renderer *renderer) :
 		this->SetRenderer(renderer);
 }
 
+// creates a blank render target (or streaming) texture
+Texture::Texture(int width, int height, SDL_Renderer *renderer, SDL_TextureAccess access) noexcept(false) :
+		mp_Renderer{renderer},
+		mp_Texture{nullptr},
+		mp_Surface{nullptr}, m_Premultiplied{},
+		m_Width{width}, m_Height{height}, m_Alpha{1.0}
+{
+	mp_Texture = SDL_CreateTexture(mp_Renderer, SDL_PIXELFORMAT_RGBA8888,
+			access, m_Width, m_Height);
+
+	if (mp_Texture == nullptr)
+		throw std::runtime_error(SDL_GetError());
+}
+
 Texture::~Texture()
 {
-	if (mp_Surface != nullptr)
-		SDL_FreeSurface(mp_Surface);
+	ImageCache::FreeSurface(mp_Surface);
 
 	if (mp_Texture != nullptr)
 		SDL_DestroyTexture(mp_Texture);
@@ -40,33 +64,120 @@ Texture::~Texture()
 // load the texture from the disk and keep a surface (system ram) around
 void Texture::Load(std::string const& filename) noexcept(false)
 {
-	SDL_Surface *tmpsurface = IMG_Load(filename.c_str());
+	Adopt(Decode(filename));
+}
+
+/* decodes an image into a RGBA8888 surface, safe to call from any thread,
+ * or maps an already decoded copy from the ImageCache if it is up to date
+ */
+SDL_Surface* Texture::Decode(std::string const& filename, Prepare const& prepare) noexcept(false)
+{
+	ImageCache cache(filename);
+	Uint64 key = 0;
+	SDL_Surface *cached = cache.Load(&key);
+
+	// cached by another step, ie. by an older build, gets cached again
+	if (cached != nullptr) {
+		try {
+			SDL_Surface *surface = Prepared(cached, prepare, key == prepare.key);
+
+			if (surface != cached)
+				cache.Store(surface, prepare.key);
+
+			return surface;
+		} catch (std::exception&) {
+			// a stale cache is never fatal, the image is still there
+		}
+	}
+
+	SDL_Surface *surface = Prepared(Convert(IMG_Load(filename.c_str())), prepare, false);
+
+	cache.Store(surface, prepare.key);
+
+	return surface;
+}
+
+// decodes an image held in memory, ie. linked into the binary, unless already decoded
+SDL_Surface* Texture::Decode(void const* data, std::size_t size, Prepare const& prepare) noexcept(false)
+{
+	Uint64 key = 0;
+	SDL_Surface *decoded = ImageCache::Load(data, size, &key);
+
+	if (decoded != nullptr)
+		return Prepared(decoded, prepare, key == prepare.key);
+
+	SDL_RWops *rw = SDL_RWFromConstMem(data, size);
+
+	if (rw == nullptr)
+		throw std::runtime_error(SDL_GetError());
+
+	// frees rw
+	return Prepared(Convert(IMG_Load_RW(rw, 1)), prepare, false);
+}
 
-	if (tmpsurface == nullptr)
+// converts a freshly decoded surface into RGBA8888, freeing it
+SDL_Surface* Texture::Convert(SDL_Surface *decoded) noexcept(false)
+{
+	if (decoded == nullptr)
 		throw std::runtime_error(IMG_GetError());
 
-	mp_Surface = SDL_ConvertSurfaceFormat(tmpsurface, SDL_PIXELFORMAT_RGBA8888, 0);
-	SDL_FreeSurface(tmpsurface);
+	SDL_Surface *surface = SDL_ConvertSurfaceFormat(decoded, SDL_PIXELFORMAT_RGBA8888, 0);
+	SDL_FreeSurface(decoded);
 
-	if (mp_Surface == nullptr)
+	if (surface == nullptr)
 		throw std::runtime_error(IMG_GetError());
 
-	m_Width = tmpsurface->w;
-	m_Height = tmpsurface->h;
+	return surface;
+}
+
+// runs prepare, if any, freeing the surface if it fails
+SDL_Surface* Texture::Prepared(SDL_Surface *surface, Prepare const& prepare, bool prepared) noexcept(false)
+{
+	if (!prepare.step)
+		return surface;
+
+	try {
+		return prepare.step(surface, prepared);
+	} catch (...) {
+		ImageCache::FreeSurface(surface);
+		throw;
+	}
+}
+
+// takes ownership of a decoded surface, as if loaded
+void Texture::Adopt(SDL_Surface *surface)
+{
+	ImageCache::FreeSurface(mp_Surface);
+
+	mp_Surface = surface;
+	m_Premultiplied.clear();
+	m_Width = mp_Surface->w;
+	m_Height = mp_Surface->h;
 }
 
 // this sets the renderer, which will upload the texture to video ram
-void Texture::SetRenderer(SDL_Renderer *renderer)
+void Texture::SetRenderer(SDL_Renderer *renderer, bool keepsurface)
 {
 	mp_Renderer = renderer;
 
 	if (mp_Texture != nullptr)
 		SDL_DestroyTexture(mp_Texture);
 
-	mp_Texture = SDL_CreateTextureFromSurface(mp_Renderer, mp_Surface);
+	// surfaces are already in their final format, so pixels go up as they are
+	mp_Texture = SDL_CreateTexture(mp_Renderer, mp_Surface->format->format,
+			SDL_TEXTUREACCESS_STATIC, m_Width, m_Height);
+
+	if (mp_Texture != nullptr && SDL_UpdateTexture(mp_Texture, nullptr,
+				mp_Surface->pixels, mp_Surface->pitch) != 0) {
+		SDL_DestroyTexture(mp_Texture);
+		mp_Texture = nullptr;
+	}
+
 	// free unused surface
-	SDL_FreeSurface(mp_Surface);
-	mp_Surface = nullptr;
+	if (!keepsurface) {
+		ImageCache::FreeSurface(mp_Surface);
+		mp_Surface = nullptr;
+	}
 
 	if (mp_Texture == nullptr)
 		throw std::runtime_error(SDL_GetError());
@@ -74,6 +185,16 @@ void Texture::SetRenderer(SDL_Renderer *renderer)
 	SDL_SetTextureBlendMode(mp_Texture, SDL_BLENDMODE_BLEND);
 }
 
+// replaces the RGBA8888 pixels of rect, or all of them, ie. of streaming textures
+void Texture::Update(SDL_Rect const* rect, void const* pixels, int pitch) noexcept(false)
+{
+	// the copy would no longer match
+	m_Premultiplied.clear();
+
+	if (SDL_UpdateTexture(mp_Texture, rect, pixels, pitch) != 0)
+		throw std::runtime_error(SDL_GetError());
+}
+
 void Texture::Alpha(double alpha)
 {
 	m_Alpha = alpha;
@@ -14,22 +14,61 @@
 #include "engine/Texture.h"
 #include "engine/TextureRegion.h"
 #include "engine/SpriteBatcher.h"
+#include "engine/FPSCounter.h"
 
 #include "Assets.h"
 
 #include "World.h"
+#include "Simulation.h"
 
 #include <string>
+#include <vector>
 
 int main(int argc, char *argv[])
 {
 	// allow specifying dimensions of the matrix board in command-line
 	int cols = 8, rows = 8;
+	// --stats logs frame rate and render state changes every second
+	bool stats = false;
+	// --tick-rate sets the simulation steps per second, independent of fps
+	int tickrate = 60;
+	// --rotations sets how many pre-rotated copies of spinning sprites the
+	// software renderer uses, 0 rotates them every time like other renderers
+	int rotations = 36;
+	// --blitter draws frames on the CPU, with "nearest" or "bilinear" scaling
+	std::string blitter;
+	// --offscreen draws at the logical size and scales the whole frame once
+	bool offscreen = false;
+	// --lod draws settled jewels as single texels on cells smaller than this
+	int lod = 8;
+	std::vector<std::string> dims;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg(argv[i]);
+
+		if (arg == "--stats")
+			stats = true;
+		else if (arg == "--tick-rate" && i + 1 < argc)
+			tickrate = std::stoi(argv[++i]);
+		else if (arg == "--offscreen")
+			offscreen = true;
+		else if (arg == "--blitter" && i + 1 < argc)
+			blitter = argv[++i];
+		else if (arg == "--rotations" && i + 1 < argc)
+			rotations = std::stoi(argv[++i]);
+		else if (arg == "--lod" && i + 1 < argc)
+			lod = std::stoi(argv[++i]);
+		else
+			dims.push_back(arg);
+	}
 
-	if (argc > 1) {
-		cols = std::stoi(argv[1]);
-		if (argc > 2)
-			rows = std::stoi(argv[2]);
+	if (tickrate < 1)
+		tickrate = 1;
+
+	if (dims.size() > 0) {
+		cols = std::stoi(dims[0]);
+		if (dims.size() > 1)
+			rows = std::stoi(dims[1]);
 		else
 			rows = cols;
 	}
@@ -39,6 +78,14 @@ int main(int argc, char *argv[])
 	if (rows < 2)
 		rows = 2;
 
+	// startup phases get timed, in performance counter ticks
+	double const frequency = SDL_GetPerformanceFrequency();
+	Uint64 const start = SDL_GetPerformanceCounter();
+
+	// get images decoding on worker threads while we set up everything else
+	Assets& assets = Assets::Instance();
+	Uint64 const assetsstarted = SDL_GetPerformanceCounter();
+
 	Engine::Graphics g;
 	// the following is defined by the background we use
 	Engine::GRect MineDimensions {
@@ -48,42 +95,121 @@ int main(int argc, char *argv[])
 		336	// h
 	};
 
-	Engine::Texture *t = Assets::Instance().background;
+	Uint64 const initialized = SDL_GetPerformanceCounter();
 
 	// create a window the size of our background
 	// could use full screen as well with SDL2's ability
 	// to keep the logical window size
-	g.Window("Jewel Miner", t->Width(), t->Height(), false);
-	Assets::Instance().SetGraphics(g);
+	g.Window("Jewel Miner", Assets::backgroundWidth, Assets::backgroundHeight, false);
+	if (!blitter.empty())
+		g.UseBlitter(blitter != "nearest");
+	if (offscreen && !g.UseOffscreen())
+		SDL_Log("Render targets unsupported, scaling every copy instead");
+
+	// show something right away, images might still be decoding
+	g.Clear();
+	g.Present();
+	Uint64 const firstframe = SDL_GetPerformanceCounter();
+
+	assets.SetGraphics(g);
+	assets.CacheRotations(g, rotations);
+	Uint64 const uploaded = SDL_GetPerformanceCounter();
 
 	// create a game with 60s timer the size we want
 	World w(&g, MineDimensions, 60, cols, rows);
+	if (w.UseLevelOfDetail(lod))
+		SDL_Log("Cells under %d pixels, drawing settled jewels as texels", lod);
+	Uint64 const ready = SDL_GetPerformanceCounter();
+
+	SDL_Log("Startup: %.1f ms to start decoding, %.1f ms SDL init, %.1f ms to first frame, "
+			"%.1f ms waiting for decoding (%.1f ms for the slowest page), "
+			"%.1f ms uploading, %.1f ms creating the world, %.1f ms total",
+			(assetsstarted - start) * 1000 / frequency,
+			(initialized - assetsstarted) * 1000 / frequency,
+			(firstframe - initialized) * 1000 / frequency,
+			assets.loadTimes.wait * 1000,
+			assets.loadTimes.decode * 1000,
+			(uploaded - firstframe) * 1000 / frequency - assets.loadTimes.wait * 1000,
+			(ready - uploaded) * 1000 / frequency,
+			(ready - start) * 1000 / frequency);
 
-	double delta = 0;
-	Uint32 starttime = SDL_GetTicks();
 	bool quit = false;
+	// time spent drawing frames since the last stats were logged
+	double drawtime = 0;
+
+	Engine::FPSCounter fps([&w, &drawtime](unsigned int frames) {
+		Engine::RenderQueue::Stats const& s = w.RenderStats();
+		SDL_Log("%u fps, %.2f ms drawing, %u sprites, %u batches, %u texture/%u clip/%u alpha changes per frame",
+				frames, drawtime * 1000 / frames, s.sprites, s.batches,
+				s.textureChanges, s.clipChanges, s.alphaChanges);
+		drawtime = 0;
+	});
+
+	/* the world is simulated in fixed steps on its own thread, so that
+	 * movement doesn't depend on the frame rate, and frames are drawn
+	 * interpolating between the last two steps of the latest snapshot
+	 */
+	Simulation sim(w, tickrate);
+
+	// the game has no use for motion events, don't let them wake us up
+	SDL_EventState(SDL_MOUSEMOTION, SDL_IGNORE);
+
+	auto handle = [&w, &sim, &quit](SDL_Event const& e) {
+		if (e.type == SDL_QUIT) {
+			quit = true;
+		} else if (e.type == SDL_WINDOWEVENT || e.type == SDL_RENDER_TARGETS_RESET) {
+			// window exposed or render targets lost, redraw everything
+			w.Invalidate();
+		} else if (e.type == SDL_MOUSEBUTTONDOWN || e.type == SDL_MOUSEBUTTONUP) {
+			int x, y;
+			SDL_GetMouseState(&x, &y);
+			sim.Click(x, y, e.type == SDL_MOUSEBUTTONUP);
+		} else if (e.type == SDL_MOUSEWHEEL) {
+			// zoom around the pointer
+			int x, y;
+			SDL_GetMouseState(&x, &y);
+			sim.Zoom(x, y, e.wheel.y);
+		} else if (e.type == SDL_KEYDOWN) {
+			// arrow keys pan the board when zoomed in
+			int const step = 48;
+
+			switch (e.key.keysym.sym) {
+			case SDLK_LEFT:
+				sim.Pan(-step, 0);
+				break;
+			case SDLK_RIGHT:
+				sim.Pan(step, 0);
+				break;
+			case SDLK_UP:
+				sim.Pan(0, -step);
+				break;
+			case SDLK_DOWN:
+				sim.Pan(0, step);
+				break;
+			default:
+				break;
+			}
+		}
+	};
 
-	// below is a classic video game loop
+	/* below is a classic video game loop, except that when nothing is
+	 * moving on every step it sleeps until the simulation publishes
+	 * something new, ie. the countdown ticking or the spark moving on,
+	 * or until some input arrives, whatever happens first
+	 */
 	while (!quit) {
 		SDL_Event e;
-		while (SDL_PollEvent(&e) != 0) {
-			if (e.type == SDL_QUIT) {
-				quit = true;
-				continue;
-			}
-			if (e.type == SDL_MOUSEBUTTONDOWN || e.type == SDL_MOUSEBUTTONUP) {
-				int x, y;
-				SDL_GetMouseState(&x, &y);
-				w.Click(x, y, e.type == SDL_MOUSEBUTTONUP);
-				continue;
-			}
-		}
 
-		Uint32 currenttime = SDL_GetTicks();
-		delta = (currenttime - starttime) / 1000.0;
-		starttime = currenttime;
-		w.Update(delta);
-		w.Render(delta);
+		if (!sim.Current().animating && sim.WaitEvent(e) != 0)
+			handle(e);
+		while (SDL_PollEvent(&e) != 0)
+			handle(e);
+
+		sim.Acquire();
+		if (w.Render(sim.Current(), sim.Blend()) && stats) {
+			drawtime += g.FrameTime();
+			fps.LogFrame();
+		}
 	}
 
 	return 0;
@@ -17,6 +17,11 @@ namespace Util {
 // statically seed the RNG
 static std::default_random_engine RNgenerator(std::chrono::system_clock::now().time_since_epoch().count());
 
+std::default_random_engine& rand_generator()
+{
+	return RNgenerator;
+}
+
 double rand_between(double min, double max)
 {
 	std::uniform_real_distribution<double> distribution(min, std::nextafter(max, std::numeric_limits<double>::max()));
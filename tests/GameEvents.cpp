@@ -0,0 +1,214 @@
+/* GameEvents.cpp - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * Plays seeded games with a Listener logging every notification, and checks
+ * that the EventStream pulled from Events() after each step tells the same
+ * story, and that MatchedCells() adds up the sizes of the Matched groups.
+ *
+ * Built and run by "make test", returns non-zero on failure.
+ */
+
+#include "miner/Game.h"
+#include "miner/Jewel.h"
+#include "miner/Listener.h"
+#include "miner/Matrix.h"
+
+#include "util/Random.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+typedef Miner::Game<Miner::Jewel> Game;
+typedef Miner::Event<Miner::Jewel> Event;
+typedef Miner::EventStream<Miner::Jewel> EventStream;
+typedef EventStream::Kind Kind;
+// a notification as kind, four fields and the target or color
+typedef std::tuple<Kind, int, int, int, int, int> Entry;
+
+Entry Decode(EventStream::Record const& r)
+{
+	switch (r.GetKind()) {
+	case Kind::Swapped:
+	case Kind::SwapOK:
+	case Kind::SwapFailed:
+		return Entry(r.GetKind(), r.Column(), r.Row(), r.Column2(), r.Row2(), 0);
+	case Kind::Destroyed:
+		return Entry(r.GetKind(), r.Count(), 0, 0, 0, 0);
+	case Kind::Matched:
+	case Kind::Fall:
+		return Entry(r.GetKind(), r.Column(), r.Row(), r.Count(), 0, 0);
+	case Kind::Deletion:
+	case Kind::Insertion:
+		return Entry(r.GetKind(), r.Num(), r.Start(), r.Count(), 0, static_cast<int>(r.GetTarget()));
+	case Kind::Delete:
+		return Entry(r.GetKind(), r.Num(), r.Start(), 0, 0, static_cast<int>(r.GetTarget()));
+	case Kind::New:
+		return Entry(r.GetKind(), r.Column(), r.Row(), r.Count(), 0, static_cast<int>(r.GetColor()));
+	case Kind::Ready:
+	case Kind::CycleFinished:
+	default:
+		return Entry(r.GetKind(), 0, 0, 0, 0, 0);
+	}
+}
+
+class Recorder : public Miner::Listener<Miner::Jewel> {
+	public:
+
+	Recorder() : log{}, matched{0}, deleted{0} {}
+
+	virtual void Swapped(int col1, int row1, int col2, int row2) {
+		log.emplace_back(Kind::Swapped, col1, row1, col2, row2, 0);
+	}
+	virtual void SwapOK(int col1, int row1, int col2, int row2) {
+		log.emplace_back(Kind::SwapOK, col1, row1, col2, row2, 0);
+	}
+	virtual void SwapFailed(int col1, int row1, int col2, int row2) {
+		log.emplace_back(Kind::SwapFailed, col1, row1, col2, row2, 0);
+	}
+	virtual void Ready() {
+		log.emplace_back(Kind::Ready, 0, 0, 0, 0, 0);
+	}
+	virtual void Destroyed(int matches) {
+		log.emplace_back(Kind::Destroyed, matches, 0, 0, 0, 0);
+	}
+	virtual void Matched(int column, int row, int size) {
+		log.emplace_back(Kind::Matched, column, row, size, 0, 0);
+		matched += size;
+	}
+	virtual void Deletion(Event::Target target, int num, int start, Event::container_type& container) {
+		log.emplace_back(Kind::Deletion, num, start, container.size(), 0, static_cast<int>(target));
+	}
+	virtual void Insertion(Event::Target target, int num, int start, Event::container_type& container) {
+		log.emplace_back(Kind::Insertion, num, start, container.size(), 0, static_cast<int>(target));
+	}
+	virtual void CycleFinished() {
+		log.emplace_back(Kind::CycleFinished, 0, 0, 0, 0, 0);
+	}
+	virtual void Fall(int column, int row, int gaps) {
+		log.emplace_back(Kind::Fall, column, row, gaps, 0, 0);
+	}
+	virtual void New(int column, int row, Miner::Jewel::Color color, int totalgaps) {
+		log.emplace_back(Kind::New, column, row, totalgaps, 0, static_cast<int>(color));
+	}
+	virtual void Delete(Event::Target target, int colrow, int pos) {
+		log.emplace_back(Kind::Delete, colrow, pos, 0, 0, static_cast<int>(target));
+		++deleted;
+	}
+
+	// notifications since the last step, and cells matched and deleted since then
+	std::vector<Entry> log;
+	int matched, deleted;
+};
+
+// checks a step of the game against what the listener heard, then forgets it
+bool Compare(Game const& game, Recorder& recorder)
+{
+	EventStream const& events = game.Events();
+	bool ok = events.size() == recorder.log.size()
+		&& std::equal(events.begin(), events.end(), recorder.log.begin(),
+			[] (EventStream::Record const& r, Entry const& e) { return Decode(r) == e; })
+		&& events.MatchedCells() == recorder.matched
+		&& recorder.matched == recorder.deleted;
+
+	recorder.log.clear();
+	recorder.matched = recorder.deleted = 0;
+	return ok;
+}
+
+// runs the game until it needs a swap, returning whether every step matched
+bool Settle(Game& game, Recorder& recorder, int& matched)
+{
+	bool ok = true;
+
+	while (!game.Ready()) {
+		game.Go();
+		matched += game.Events().MatchedCells();
+		ok &= Compare(game, recorder);
+	}
+
+	return ok;
+}
+
+bool Expect(char const* what, bool ok)
+{
+	std::printf("%s: %s\n", ok ? "ok" : "FAIL", what);
+	return ok;
+}
+
+}
+
+int main()
+{
+	bool ok = true;
+
+	Util::rand_generator().seed(20141018);
+
+	{
+		Recorder recorder;
+		Game game(std::make_shared<Game::matrix_type>(8, 8), &recorder);
+		bool same = true;
+		int matched = 0;
+
+		game.RecordEvents(true);
+		same &= Settle(game, recorder, matched);
+		for (int swaps = 0; swaps < 500; ++swaps) {
+			int const col = Util::rand_between(0, 6), row = Util::rand_between(0, 7);
+
+			game.Swap(col, row, col + 1, row);
+			same &= Settle(game, recorder, matched);
+		}
+
+		ok &= Expect("500 swaps on 8x8 pull the events the listener was told", same);
+		ok &= Expect("500 swaps on 8x8 match some cells", matched > 0);
+	}
+
+	{
+		// a single group bigger than 16 bits can count
+		Recorder recorder;
+		auto matrix = std::make_shared<Game::matrix_type>(300, 300);
+		Game game(matrix, &recorder);
+		int matched = 0;
+
+		for (Miner::Jewel& jewel : *matrix)
+			jewel.SetColor(Miner::Jewel::Color::Red);
+		game.RecordEvents(true);
+
+		ok &= Expect("a 300x300 board of one color pulls the events the listener was told",
+				Settle(game, recorder, matched));
+		ok &= Expect("a 300x300 board of one color matches all of it", matched >= 300 * 300);
+	}
+
+	{
+		EventStream events;
+
+		events.Push(Kind::Destroyed, 70000);
+		events.Push(Kind::Matched, 299, 299, 70000);
+		ok &= Expect("counts above 16 bits survive a Record",
+				Decode(*events.begin()) == Entry(Kind::Destroyed, 70000, 0, 0, 0, 0)
+				&& Decode(*(events.begin() + 1)) == Entry(Kind::Matched, 299, 299, 70000, 0, 0)
+				&& events.MatchedCells() == 70000);
+	}
+
+	{
+		Recorder recorder;
+		Game game(std::make_shared<Game::matrix_type>(8, 8), &recorder);
+
+		game.Go();
+		ok &= Expect("a game with a listener records nothing by default",
+				game.Events().empty() && !recorder.log.empty());
+	}
+
+	{
+		Game game(std::make_shared<Game::matrix_type>(8, 8));
+
+		game.Go();
+		ok &= Expect("a game without a listener records by default", !game.Events().empty());
+	}
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
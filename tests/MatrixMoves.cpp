@@ -0,0 +1,84 @@
+/* MatrixMoves.cpp - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * Counts the allocations made by getting columns and rows out of a Matrix,
+ * so that moves which quietly turn back into copies get caught.
+ *
+ * Built and run by "make test", returns non-zero on failure.
+ */
+
+#include "miner/Matrix.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace {
+
+unsigned long allocations = 0;
+
+// what a block of code allocates
+template <typename F>
+unsigned long Allocations(F f)
+{
+	unsigned long const before = allocations;
+
+	f();
+	return allocations - before;
+}
+
+bool Expect(char const* what, unsigned long allocs, unsigned long most)
+{
+	bool const ok = allocs <= most;
+
+	std::printf("%s: %s, %lu allocations (at most %lu)\n", ok ? "ok" : "FAIL", what, allocs, most);
+	return ok;
+}
+
+}
+
+void* operator new(std::size_t size)
+{
+	++allocations;
+	if (void *p = std::malloc(size != 0 ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+	std::free(p);
+}
+
+int main()
+{
+	typedef Miner::Matrix<int> Matrix;
+	Matrix const matrix(16, 16);
+	bool ok = true;
+
+	// the vector, plus one buffer per column, none copied
+	ok &= Expect("GetColumns() on 16x16", Allocations([&matrix] {
+		std::vector<Matrix::Column> columns(matrix.GetColumns());
+	}), 1 + 16);
+
+	ok &= Expect("GetRows() on 16x16", Allocations([&matrix] {
+		std::vector<Matrix::Row> rows(matrix.GetRows());
+	}), 1 + 16);
+
+	Matrix::Column column(matrix.GetColumn(0));
+
+	ok &= Expect("move constructing a Column", Allocations([&column] {
+		Matrix::Column moved(std::move(column));
+		column = std::move(moved);
+	}), 0);
+
+	ok &= Expect("growing a vector of Columns", Allocations([&matrix] {
+		std::vector<Matrix::Column> columns;
+
+		for (int i = 0; i < 16; ++i)
+			columns.push_back(matrix.GetColumn(i));
+	}), 16 + 5);
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
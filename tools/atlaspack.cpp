@@ -0,0 +1,397 @@
+/* atlaspack.cpp - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * Offline texture atlas packer.
+ *
+ * Reads a spec listing named regions of source images, one per line:
+ *
+ *   # name       image              x    y    w    h
+ *   background   BackGround.jpg     0    0    755  600
+ *
+ * and packs them all into as few pages as possible, no bigger than a maximum
+ * size, each region surrounded by a 1 pixel border repeating its edges so
+ * that filtering never samples its neighbours. Pages are saved as PNG and a
+ * constexpr manifest header describes where every region ended up.
+ *
+ * Usage: atlaspack <spec> <page prefix> <manifest header> [max page size]
+ *
+ * Paths in the spec, and the pages written, are relative to the current
+ * directory. The occupancy of each page is printed and recorded in the
+ * manifest.
+ */
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int border = 1;
+// pages are grown in these steps, so that their size stays a bit rounded
+constexpr int granularity = 4;
+
+struct Item {
+	std::string name;
+	std::string image;
+	SDL_Rect src;
+	int page;
+	int x, y;	// of the region itself, past its border
+};
+
+struct Page {
+	int width, height;
+	std::vector<Item*> items;
+	long used;
+};
+
+int RoundUp(int value)
+{
+	return (value + granularity - 1) / granularity * granularity;
+}
+
+std::vector<Item> ReadSpec(std::string const& filename) noexcept(false)
+{
+	std::ifstream in(filename);
+	std::vector<Item> items;
+	std::string line;
+	int lineno = 0;
+
+	if (!in)
+		throw std::runtime_error("Can't open " + filename);
+
+	while (std::getline(in, line)) {
+		std::istringstream fields(line);
+		Item item;
+
+		++lineno;
+		if (!(fields >> item.name) || item.name[0] == '#')
+			continue;
+
+		if (!(fields >> item.image >> item.src.x >> item.src.y >> item.src.w >> item.src.h) ||
+				item.src.w <= 0 || item.src.h <= 0)
+			throw std::runtime_error(filename + ":" + std::to_string(lineno) + ": bad region");
+
+		item.page = -1;
+		item.x = item.y = 0;
+		items.push_back(item);
+	}
+
+	return items;
+}
+
+/* skyline bottom-left packing of the items, in order, into a page of the
+ * given width: returns the height used, or -1 if some item didn't fit
+ * under maxheight, in which case only the ones that did are placed
+ */
+int Pack(std::vector<Item*> const& items, int width, int maxheight, std::vector<Item*>& placed)
+{
+	// the skyline is a list of segments: x, width, height
+	struct Segment { int x, w, y; };
+	std::vector<Segment> skyline { Segment{0, width, 0} };
+	int height = 0;
+	bool all = true;
+
+	placed.clear();
+	for (auto item : items) {
+		int const w = item->src.w + 2 * border;
+		int const h = item->src.h + 2 * border;
+		int bestx = -1, besty = maxheight;
+		std::size_t best = 0;
+
+		for (std::size_t i = 0; i < skyline.size(); ++i) {
+			int const x = skyline[i].x;
+			int y = 0;
+			int covered = 0;
+
+			if (x + w > width)
+				break;
+			// the item rests on the highest segment it spans
+			for (std::size_t j = i; covered < w && j < skyline.size(); ++j) {
+				y = std::max(y, skyline[j].y);
+				covered += skyline[j].w;
+			}
+			if (y + h <= maxheight && y < besty) {
+				bestx = x;
+				besty = y;
+				best = i;
+			}
+		}
+
+		if (bestx < 0) {
+			all = false;
+			continue;
+		}
+
+		item->x = bestx + border;
+		item->y = besty + border;
+		placed.push_back(item);
+		height = std::max(height, besty + h);
+
+		// raise the skyline where the item landed
+		Segment raised { bestx, w, besty + h };
+		std::size_t end = best;
+		int right = bestx + w;
+		while (end < skyline.size() && skyline[end].x + skyline[end].w <= right)
+			++end;
+		if (end < skyline.size() && skyline[end].x < right) {
+			skyline[end].w -= right - skyline[end].x;
+			skyline[end].x = right;
+		}
+		skyline.erase(skyline.begin() + best, skyline.begin() + end);
+		skyline.insert(skyline.begin() + best, raised);
+	}
+
+	return all ? height : -1;
+}
+
+/* fills pages one after the other, picking for each the width that wastes
+ * the least area, while making sure it takes as many of the items left
+ */
+std::vector<Page> Paginate(std::vector<Item>& items, int maxsize) noexcept(false)
+{
+	std::vector<Item*> left;
+	std::vector<Page> pages;
+
+	for (auto& item : items) {
+		if (item.src.w + 2 * border > maxsize || item.src.h + 2 * border > maxsize)
+			throw std::runtime_error(item.name + " doesn't fit in a " + std::to_string(maxsize) + " pixels page");
+		left.push_back(&item);
+	}
+
+	// tallest first, then widest, works well for skylines
+	std::stable_sort(left.begin(), left.end(), [](Item const* a, Item const* b) {
+			return a->src.h != b->src.h ? a->src.h > b->src.h : a->src.w > b->src.w;
+		});
+
+	while (!left.empty()) {
+		Page page { 0, 0, {}, 0 };
+		long bestarea = 0;
+		std::vector<Item*> placed;
+
+		for (int width = granularity; width <= maxsize; width += granularity) {
+			int height = Pack(left, width, maxsize, placed);
+			bool better;
+
+			if (placed.empty())
+				continue;
+
+			height = RoundUp(height < 0 ? maxsize : height);
+			long const area = static_cast<long>(width) * height;
+			// more items always wins, then less area
+			better = page.items.empty() || placed.size() > page.items.size() ||
+				(placed.size() == page.items.size() && area < bestarea);
+
+			if (better) {
+				page.width = width;
+				page.height = std::min(height, maxsize);
+				page.items = placed;
+				bestarea = area;
+			}
+		}
+
+		// pack again with the winner so that item positions match it
+		Pack(left, page.width, page.height, page.items);
+		for (auto item : page.items) {
+			item->page = pages.size();
+			page.used += static_cast<long>(item->src.w) * item->src.h;
+		}
+
+		left.erase(std::remove_if(left.begin(), left.end(), [](Item const* item) {
+				return item->page >= 0;
+			}), left.end());
+		pages.push_back(page);
+	}
+
+	return pages;
+}
+
+SDL_Surface* LoadImage(std::string const& filename) noexcept(false)
+{
+	SDL_Surface *loaded = IMG_Load(filename.c_str());
+
+	if (loaded == nullptr)
+		throw std::runtime_error(filename + ": " + IMG_GetError());
+
+	SDL_Surface *surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA8888, 0);
+	SDL_FreeSurface(loaded);
+
+	if (surface == nullptr)
+		throw std::runtime_error(filename + ": " + SDL_GetError());
+
+	return surface;
+}
+
+// copies the region of the item, repeating its edges over its border
+void Copy(SDL_Surface *page, SDL_Surface const* image, Item const& item) noexcept(false)
+{
+	SDL_Rect const& src = item.src;
+
+	if (src.x < 0 || src.y < 0 || src.x + src.w > image->w || src.y + src.h > image->h)
+		throw std::runtime_error(item.name + " falls outside of " + item.image);
+
+	for (int y = -border; y < src.h + border; ++y) {
+		int const sy = src.y + std::min(std::max(y, 0), src.h - 1);
+		Uint32 const* in = reinterpret_cast<Uint32 const*>(
+				static_cast<Uint8 const*>(image->pixels) + sy * image->pitch);
+		Uint32 *out = reinterpret_cast<Uint32*>(
+				static_cast<Uint8*>(page->pixels) + (item.y + y) * page->pitch);
+
+		for (int x = -border; x < src.w + border; ++x)
+			out[item.x + x] = in[src.x + std::min(std::max(x, 0), src.w - 1)];
+	}
+}
+
+std::string Identifier(std::string const& name) noexcept(false)
+{
+	bool valid = !name.empty() && !std::isdigit(static_cast<unsigned char>(name[0]));
+
+	for (auto c : name)
+		valid = valid && (std::isalnum(static_cast<unsigned char>(c)) || c == '_');
+
+	if (!valid)
+		throw std::runtime_error(name + " is not a valid C++ identifier");
+
+	return name;
+}
+
+void WriteManifest(std::string const& filename, std::string const& spec, std::string const& prefix,
+		std::vector<Item> const& items, std::vector<Page> const& pages) noexcept(false)
+{
+	std::ofstream out(filename);
+	std::string guard = filename.substr(filename.find_last_of("/\\") + 1);
+
+	for (auto& c : guard)
+		c = std::isalnum(static_cast<unsigned char>(c)) ? std::toupper(c) : '_';
+
+	out << "/* " << filename.substr(filename.find_last_of("/\\") + 1)
+		<< " - generated by tools/atlaspack from " << spec << ", do not edit\n"
+		<< " *\n"
+		<< " * Where each region was packed into the atlas pages. Coordinates are in\n"
+		<< " * pixels from the top left corner of the page.\n"
+		<< " *\n";
+	for (std::size_t i = 0; i < pages.size(); ++i)
+		out << " * Page " << i << ": " << pages[i].width << "x" << pages[i].height << ", "
+			<< pages[i].items.size() << " regions, " << (pages[i].used * 1000 /
+			(static_cast<long>(pages[i].width) * pages[i].height)) / 10.0 << "% used\n";
+	out << " */\n\n"
+		<< "#ifndef " << guard << "__\n"
+		<< "#define " << guard << "__\n\n"
+		<< "namespace AtlasManifest {\n\n"
+		<< "struct Region {\n"
+		<< "\tint page;\n"
+		<< "\tint x, y, w, h;\n"
+		<< "};\n\n"
+		<< "struct Size {\n"
+		<< "\tint w, h;\n"
+		<< "};\n\n"
+		<< "constexpr int pageCount = " << pages.size() << ";\n\n"
+		<< "constexpr char const* pages[pageCount] = {\n";
+	for (std::size_t i = 0; i < pages.size(); ++i)
+		out << "\t\"" << prefix << i << ".png\"" << (i + 1 < pages.size() ? ",\n" : "\n");
+	out << "};\n\n";
+
+	// so that the game knows them before decoding any page
+	out << "constexpr Size pageSizes[pageCount] = {\n";
+	for (std::size_t i = 0; i < pages.size(); ++i)
+		out << "\t{ " << pages[i].width << ", " << pages[i].height << " }"
+			<< (i + 1 < pages.size() ? ",\n" : "\n");
+	out << "};\n\n";
+
+	// names given by "ld -r -b binary" to the pages, when linked into the binary
+	out << "// PAGE(symbol, file) for every page, symbol being the file name as an identifier\n"
+		<< "#define ATLASMANIFEST_PAGES(PAGE)";
+	for (std::size_t i = 0; i < pages.size(); ++i) {
+		std::string file = prefix.substr(prefix.find_last_of("/\\") + 1) + std::to_string(i) + ".png";
+		std::string symbol = file;
+
+		for (auto& c : symbol)
+			c = std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+		out << " \\\n\tPAGE(" << symbol << ", \"" << file << "\")";
+	}
+	out << "\n\n";
+
+	for (auto const& item : items)
+		out << "constexpr Region " << Identifier(item.name) << " { " << item.page << ", "
+			<< item.x << ", " << item.y << ", " << item.src.w << ", " << item.src.h << " };\n";
+
+	out << "\n}\t// AtlasManifest\n\n#endif\n";
+
+	if (!out)
+		throw std::runtime_error("Can't write " + filename);
+}
+
+}	// anonymous namespace
+
+int main(int argc, char *argv[])
+{
+	if (argc < 4 || argc > 5) {
+		std::cerr << "Usage: " << argv[0] << " <spec> <page prefix> <manifest header> [max page size]" << std::endl;
+		return 1;
+	}
+
+	std::string const spec = argv[1];
+	std::string const prefix = argv[2];
+	std::string const manifest = argv[3];
+	int const maxsize = argc == 5 ? std::stoi(argv[4]) : 2048;
+	std::map<std::string, SDL_Surface*> images;
+	int result = 0;
+
+	IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG);
+
+	try {
+		std::vector<Item> items = ReadSpec(spec);
+		std::vector<Page> pages = Paginate(items, maxsize);
+		long used = 0, total = 0;
+
+		for (auto const& item : items)
+			if (images.find(item.image) == images.end())
+				images[item.image] = LoadImage(item.image);
+
+		for (std::size_t i = 0; i < pages.size(); ++i) {
+			Page const& page = pages[i];
+			std::string const filename = prefix + std::to_string(i) + ".png";
+			SDL_Surface *surface = SDL_CreateRGBSurface(0, page.width, page.height, 32,
+					0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff);
+
+			if (surface == nullptr)
+				throw std::runtime_error(SDL_GetError());
+
+			SDL_FillRect(surface, nullptr, 0);
+			for (auto item : page.items)
+				Copy(surface, images[item->image], *item);
+
+			int saved = IMG_SavePNG(surface, filename.c_str());
+			SDL_FreeSurface(surface);
+			if (saved != 0)
+				throw std::runtime_error(filename + ": " + IMG_GetError());
+
+			long const area = static_cast<long>(page.width) * page.height;
+			std::cout << filename << ": " << page.width << "x" << page.height << ", "
+				<< page.items.size() << " regions, " << (page.used * 1000 / area) / 10.0
+				<< "% used" << std::endl;
+			used += page.used;
+			total += area;
+		}
+
+		WriteManifest(manifest, spec, prefix, items, pages);
+		std::cout << items.size() << " regions in " << pages.size() << " pages, "
+			<< (used * 1000 / total) / 10.0 << "% used overall" << std::endl;
+	} catch (std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		result = 1;
+	}
+
+	for (auto& image : images)
+		SDL_FreeSurface(image.second);
+	IMG_Quit();
+
+	return result;
+}
@@ -0,0 +1,156 @@
+/* blitbench.cpp - Copyright (c) 2014 Alejandro Martinez Ruiz <alex@flawedcode.org>
+ *
+ * Frame benchmark of the CPU Blitter against SDL's software renderer.
+ *
+ * Both draw the same frame as the game does: the background, then a board
+ * clipped to the mine, with one in eleven jewels spinning and some of them
+ * half transparent. Boards of 16x16 and 64x64 cells are timed. Frames are
+ * drawn onto a surface through SDL_CreateSoftwareRenderer(), so no display
+ * is needed, and the Blitter uploads its frame to that same surface.
+ *
+ * Usage: blitbench [nearest|bilinear] [frames]
+ *
+ * Run from bin/, like the game, so that ../res/ holds the atlas pages.
+ */
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+#include "engine/Blitter.h"
+#include "engine/Graphics.h"	// for GRect
+#include "engine/Texture.h"
+
+#include "AtlasManifest.h"
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// the mine of the background, see main.cpp
+Engine::GRect const mine { 330, 100, 336, 336 };
+
+Engine::GRect Rect(AtlasManifest::Region const& region)
+{
+	return Engine::GRect{ region.x, region.y, region.w, region.h };
+}
+
+/* draws a frame with draw(src, dst, angle), clipping the board with
+ * clip(rect), clip(nullptr) lifting it
+ */
+template <typename Draw, typename Clip>
+void Frame(int cells, int frame, Engine::Texture *page, Draw draw, Clip clip)
+{
+	Engine::GRect const jewels[] = {
+		Rect(AtlasManifest::jewelYellow), Rect(AtlasManifest::jewelRed),
+		Rect(AtlasManifest::jewelPurple), Rect(AtlasManifest::jewelGreen),
+		Rect(AtlasManifest::jewelBlue)
+	};
+	Engine::GRect const background = Rect(AtlasManifest::background);
+	Engine::GRect const screen { 0, 0, background.w, background.h };
+	int const side = mine.w / cells;
+	int const jewel = side - side / 20;
+
+	page->Alpha(1.0);
+	draw(background, screen, 0);
+
+	clip(&mine);
+	for (int row = 0; row < cells; ++row) {
+		for (int col = 0; col < cells; ++col) {
+			Engine::GRect const dst { mine.x + col * side, mine.y + row * side, jewel, jewel };
+			double const angle = (row + col) % 11 == 0 ? frame * 7.0 + row : 0;
+
+			page->Alpha((row * col) % 9 == 0 ? 0.5 : 1.0);
+			draw(jewels[(row + col) % 5], dst, angle);
+		}
+	}
+	clip(nullptr);
+}
+
+// milliseconds per frame
+template <typename Draw>
+double Time(int frames, Draw draw)
+{
+	Uint64 const start = SDL_GetPerformanceCounter();
+
+	for (int frame = 0; frame < frames; ++frame)
+		draw(frame);
+
+	return (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency() / frames;
+}
+
+}	// anonymous namespace
+
+int main(int argc, char *argv[])
+{
+	bool const bilinear = argc > 1 && std::strcmp(argv[1], "bilinear") == 0;
+	int const frames = argc > 2 ? std::stoi(argv[2]) : 200;
+	int result = 0;
+
+	if (argc > 3 || (argc > 1 && !bilinear && std::strcmp(argv[1], "nearest") != 0) || frames <= 0) {
+		std::cerr << "Usage: " << argv[0] << " [nearest|bilinear] [frames]" << std::endl;
+		return 1;
+	}
+
+	SDL_Init(0);
+	IMG_Init(IMG_INIT_PNG);
+	// textures made from now on are filtered like the Blitter
+	SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, bilinear ? "1" : "0");
+
+	SDL_Surface *target = SDL_CreateRGBSurface(0, AtlasManifest::background.w, AtlasManifest::background.h,
+			32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+	SDL_Renderer *renderer = target != nullptr ? SDL_CreateSoftwareRenderer(target) : nullptr;
+
+	try {
+		if (renderer == nullptr)
+			throw std::runtime_error(SDL_GetError());
+
+		// the Blitter reads the pixels kept in system memory
+		Engine::Texture page;
+		page.Adopt(Engine::Texture::Decode(std::string("../res/") + AtlasManifest::pages[0]));
+		page.SetRenderer(renderer, true);
+
+		Engine::Blitter blitter(renderer, target->w, target->h,
+				bilinear ? Engine::Blitter::Filter::Bilinear : Engine::Blitter::Filter::Nearest);
+
+		for (int cells : { 16, 64 }) {
+			double const sdl = Time(frames, [&] (int frame) {
+				SDL_RenderClear(renderer);
+				Frame(cells, frame, &page,
+					[&] (Engine::GRect const& src, Engine::GRect const& dst, double angle) {
+						SDL_RenderCopyEx(renderer, page.Tex(), &src, &dst, angle, nullptr, SDL_FLIP_NONE);
+					},
+					[&] (Engine::GRect const* clip) { SDL_RenderSetClipRect(renderer, clip); });
+				SDL_RenderPresent(renderer);
+			});
+
+			double const blit = Time(frames, [&] (int frame) {
+				blitter.Clear();
+				Frame(cells, frame, &page,
+					[&] (Engine::GRect const& src, Engine::GRect const& dst, double angle) {
+						blitter.Draw(&page, src, dst, angle);
+					},
+					[&] (Engine::GRect const* clip) { blitter.SetClip(clip); });
+				blitter.Upload();
+				SDL_RenderPresent(renderer);
+			});
+
+			std::cout << cells << "x" << cells << " " << (bilinear ? "bilinear" : "nearest")
+				<< ": SDL software " << sdl << " ms, Blitter " << blit << " ms, "
+				<< sdl / blit << "x" << std::endl;
+		}
+	} catch (std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		result = 1;
+	}
+
+	if (renderer != nullptr)
+		SDL_DestroyRenderer(renderer);
+	SDL_FreeSurface(target);
+	IMG_Quit();
+	SDL_Quit();
+
+	return result;
+}